@@ -1,19 +1,114 @@
 #pragma once
 
+#include "Entity.h"
+#include "Mapping.h"
 #include "tl/multivector.h"
 
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <memory>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
-#include <deque>
 
 namespace nete {
 template <typename... Args> struct Chunks {};
 
-template <typename T, class Mapping, class EntityTraits, class ComponentTraits>
+// the traits of the component storage, which are also the traits of its
+// `multivector`
+struct DefaultComponentTraits {
+  using allocator_type = std::allocator<char>;
+  using size_type = std::uint32_t;
+  static constexpr bool disable_initialization = false;
+};
+
+// the number of the first `I` chunk types that are stored in columns; empty
+// chunk types have no state, so they have no columns either
+template <std::size_t I, typename... T>
+struct stored_chunks_before : std::integral_constant<std::size_t, 0> {};
+
+template <std::size_t I, typename Head, typename... Tail>
+struct stored_chunks_before<I, Head, Tail...>
+    : std::integral_constant<
+          std::size_t,
+          I == 0 ? 0
+                 : !std::is_empty<Head>::value +
+                       stored_chunks_before<(I ? I - 1 : 0), Tail...>::value> {
+};
+
+// the indices of the stored chunk types
+template <std::size_t I, typename Indices, typename... T>
+struct stored_chunk_indices {
+  using type = Indices;
+};
+
+template <std::size_t I, std::size_t... J, typename Head, typename... Tail>
+struct stored_chunk_indices<I, tl::index_sequence<J...>, Head, Tail...>
+    : stored_chunk_indices<
+          I + 1, typename std::conditional<std::is_empty<Head>::value,
+                                           tl::index_sequence<J...>,
+                                           tl::index_sequence<J..., I>>::type,
+          Tail...> {};
+
+// the multivector of the rows: the `Prefix` columns, then the stored chunks
+template <typename Prefix, typename Traits, typename Indices,
+          typename... ChunkTypes>
+struct component_storage;
+
+template <typename... Prefix, typename Traits, std::size_t... J,
+          typename... ChunkTypes>
+struct component_storage<tl::types<Prefix...>, Traits,
+                         tl::index_sequence<J...>, ChunkTypes...> {
+  using type = tl::multivector<
+      tl::types<Prefix..., tl::nth_type_of<J, ChunkTypes...>...>, Traits>;
+};
+
+// traits may omit `track_changes`, in which case the rows have no change
+// ticks
+template <class Traits, typename = void>
+struct component_track_changes : std::false_type {};
+
+template <class Traits>
+struct component_track_changes<Traits,
+                               tl::void_t<decltype(Traits::track_changes)>>
+    : std::integral_constant<bool, Traits::track_changes> {};
+
+// the state of the change detection of a component, empty if it's disabled
+template <bool TrackChanges> struct component_changes {
+  void clear() noexcept {}
+};
+
+template <> struct component_changes<true> {
+  // the tick stamped on the rows changed now
+  std::uint32_t tick = 1;
+  // the highest tick of each block of rows, or more
+  std::vector<std::uint32_t> block_ticks;
+
+  // forgets the rows, but not the tick, which has to stay monotonic for the
+  // ticks already seen by the systems
+  void clear() noexcept { block_ticks.clear(); }
+};
+
+template <typename T, class Mapping = PagedSparseArrayMapping<>,
+          class EntityTraits = DefaultEntityTraits,
+          class ComponentTraits = DefaultComponentTraits>
 class Component
     : public Component<Chunks<T>, Mapping, EntityTraits, ComponentTraits> {};
 
+// a sparse set of entities with their chunks: the rows are packed in
+// a `multivector`, the first column of which holds the entity of each row,
+// and `Mapping` maps the entity indices back to the rows. Adding, removing and
+// finding an entity is O(1); removing moves the last row in place of the
+// removed one, so the rows are unordered. Empty chunk types, i.e. tags, take
+// no columns; a component of only tags stores just its entities.
+//
+// With `ComponentTraits::track_changes`, the second column holds the tick of
+// the last change of each row, which is stamped when a row is added, accessed
+// by a mutable `get` or `at`, or passed to `mark_changed`. `changed_since`
+// iterates over the rows changed after a tick, skipping whole blocks of
+// unchanged rows by their highest tick.
 template <typename... ChunkTypes, class Mapping, class EntityTraits,
           class ComponentTraits>
 class Component<Chunks<ChunkTypes...>, Mapping, EntityTraits, ComponentTraits> {
@@ -22,26 +117,519 @@ public:
   using value_type =
       typename std::tuple_element<ChunkIndex, std::tuple<ChunkTypes...>>::type;
 
+  using entity_type = typename EntityTraits::entity_type;
   using size_type = typename ComponentTraits::size_type;
+  using tick_type = std::uint32_t;
 
-  class iterator {
+  static constexpr bool track_changes =
+      component_track_changes<ComponentTraits>::value;
+  static constexpr size_type change_block_size = 64;
+
+  using stored_chunks =
+      typename stored_chunk_indices<0, tl::index_sequence<>,
+                                    ChunkTypes...>::type;
+  using storage_type = typename component_storage<
+      typename std::conditional<track_changes,
+                                tl::types<entity_type, tick_type>,
+                                tl::types<entity_type>>::type,
+      ComponentTraits, stored_chunks, ChunkTypes...>::type;
+  using mapping_type = typename Mapping::template mapping_type<size_type>;
+  using iterator = typename storage_type::iterator;
+
+  class changed_iterator
+      : public std::iterator<std::forward_iterator_tag, iterator> {
   public:
+    changed_iterator(const Component *component, size_type row,
+                     tick_type since)
+        : _component(component), _row(row), _since(since) {}
+
+    iterator operator*() const { return iterator{_row}; }
+
+    changed_iterator &operator++() {
+      _row = _component->next_changed(_row + 1, _since);
+      return *this;
+    }
+    changed_iterator operator++(int) {
+      changed_iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+
+    bool operator==(const changed_iterator &rhs) const {
+      return _row == rhs._row;
+    }
+    bool operator!=(const changed_iterator &rhs) const {
+      return _row != rhs._row;
+    }
+
   private:
-    size_type _index;
+    const Component *_component;
+    size_type _row;
+    tick_type _since;
+  };
+
+  struct changed_range {
+    changed_iterator first;
+    changed_iterator last;
+
+    changed_iterator begin() const { return first; }
+    changed_iterator end() const { return last; }
   };
 
   template <unsigned ChunkIndex> value_type<ChunkIndex> &get(iterator it);
+  template <unsigned ChunkIndex>
+  const value_type<ChunkIndex> &get(iterator it) const;
+  template <unsigned ChunkIndex> value_type<ChunkIndex> &at(entity_type entity);
+  template <unsigned ChunkIndex>
+  const value_type<ChunkIndex> &at(entity_type entity) const;
+  template <unsigned ChunkIndex> value_type<ChunkIndex> *data() noexcept;
+  template <unsigned ChunkIndex>
+  const value_type<ChunkIndex> *data() const noexcept;
+  entity_type entity(iterator it) const;
+  const entity_type *entities() const noexcept;
 
-  iterator begin();
-  iterator end();
+  iterator begin() const noexcept;
+  iterator end() const noexcept;
+  iterator find(entity_type entity) const noexcept;
+  bool has(entity_type entity) const noexcept;
 
-  bool empty();
-  size_type size();
+  bool empty() const noexcept;
+  size_type size() const noexcept;
   void reserve(size_type new_cap);
 
-  void push_back(const ChunkTypes &... val);
+  iterator insert(entity_type entity, const ChunkTypes &... values);
+  iterator emplace(entity_type entity);
+  template <class... Args>
+  iterator emplace(entity_type entity, Args &&... args);
+  void erase(entity_type entity);
+  void clear() noexcept;
+
+  tick_type tick() const noexcept;
+  tick_type advance_tick() noexcept;
+  void mark_changed(iterator it);
+  tick_type change_tick(iterator it) const;
+  changed_range changed_since(tick_type since) const;
 
 private:
-  tl::multivector<tl::types<ChunkTypes...>> _storage;
+  using track_changes_t = std::integral_constant<bool, track_changes>;
+
+  // the column of the chunk in the storage, after the entity column and the
+  // tick column, if any
+  template <unsigned ChunkIndex>
+  using column = std::integral_constant<
+      std::size_t, (track_changes ? 2 : 1) +
+                       stored_chunks_before<ChunkIndex, ChunkTypes...>::value>;
+  template <unsigned ChunkIndex>
+  using is_tag = std::is_empty<value_type<ChunkIndex>>;
+
+  static std::size_t index(entity_type entity) noexcept;
+  size_type row(entity_type entity) const noexcept;
+  template <unsigned ChunkIndex>
+  value_type<ChunkIndex> &chunk(size_type row, std::false_type);
+  template <unsigned ChunkIndex>
+  value_type<ChunkIndex> &chunk(size_type row, std::true_type);
+  template <class Tuple, std::size_t... J>
+  void emplace_back(entity_type entity, Tuple &&args,
+                    tl::index_sequence<J...>, std::false_type);
+  template <class Tuple, std::size_t... J>
+  void emplace_back(entity_type entity, Tuple &&args,
+                    tl::index_sequence<J...>, std::true_type);
+  void stamp(size_type row, std::false_type) noexcept;
+  void stamp(size_type row, std::true_type);
+  void update_block_tick(size_type row, std::false_type) noexcept;
+  void update_block_tick(size_type row, std::true_type);
+  size_type next_changed(size_type row, tick_type since) const noexcept;
+
+  storage_type _storage;
+  mapping_type _mapping;
+  component_changes<track_changes> _changes;
 };
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+constexpr bool Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+                         ComponentTraits>::track_changes;
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+constexpr typename Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+                             ComponentTraits>::size_type
+    Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+              ComponentTraits>::change_block_size;
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+template <unsigned ChunkIndex>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::get(iterator it) -> value_type<ChunkIndex> & {
+  mark_changed(it);
+  return chunk<ChunkIndex>(*it, is_tag<ChunkIndex>{});
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+template <unsigned ChunkIndex>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::get(iterator it) const
+    -> const value_type<ChunkIndex> & {
+  return const_cast<Component *>(this)->template chunk<ChunkIndex>(
+      *it, is_tag<ChunkIndex>{});
+}
+
+// the chunk of `entity`, which has to be in the component
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+template <unsigned ChunkIndex>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::at(entity_type entity)
+    -> value_type<ChunkIndex> & {
+  size_type entity_row = row(entity);
+  stamp(entity_row, track_changes_t{});
+  return chunk<ChunkIndex>(entity_row, is_tag<ChunkIndex>{});
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+template <unsigned ChunkIndex>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::at(entity_type entity) const
+    -> const value_type<ChunkIndex> & {
+  return const_cast<Component *>(this)->template chunk<ChunkIndex>(
+      row(entity), is_tag<ChunkIndex>{});
+}
+
+// the packed array of a chunk, for running a system over all the rows; tags
+// have no arrays. Writing to it doesn't stamp the rows as changed.
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+template <unsigned ChunkIndex>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::data() noexcept -> value_type<ChunkIndex> * {
+  static_assert(!is_tag<ChunkIndex>::value, "Tags aren't stored!");
+  return _storage.template data<column<ChunkIndex>::value>();
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+template <unsigned ChunkIndex>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::data() const noexcept
+    -> const value_type<ChunkIndex> * {
+  static_assert(!is_tag<ChunkIndex>::value, "Tags aren't stored!");
+  return _storage.template data<column<ChunkIndex>::value>();
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::entity(iterator it) const -> entity_type {
+  return _storage.template get<0>(it);
+}
+
+// the packed array of the entities, parallel to the chunk arrays
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::entities() const noexcept
+    -> const entity_type * {
+  return _storage.template data<0>();
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::begin() const noexcept -> iterator {
+  return iterator{0};
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::end() const noexcept -> iterator {
+  return iterator{size()};
+}
+
+// the row of `entity`, or `end()` if it isn't in the component
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::find(entity_type entity) const noexcept
+    -> iterator {
+  size_type found = _mapping.find(index(entity));
+  return found == mapping_type::npos ? end() : iterator{found};
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+bool Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::has(entity_type entity) const noexcept {
+  return _mapping.find(index(entity)) != mapping_type::npos;
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+bool Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::empty() const noexcept {
+  return _storage.empty();
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::size() const noexcept -> size_type {
+  return _storage.size();
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+void Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::reserve(size_type new_cap) {
+  _storage.reserve(new_cap);
+}
+
+// adds `entity`, which mustn't be in the component yet, with copies of
+// `values` as its chunks
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::insert(entity_type entity,
+                                        const ChunkTypes &... values)
+    -> iterator {
+  return emplace(entity, values...);
+}
+
+// adds `entity`, which mustn't be in the component yet, with value-initialized
+// chunks
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::emplace(entity_type entity) -> iterator {
+  return emplace(entity, ChunkTypes()...);
+}
+
+// adds `entity`, which mustn't be in the component yet, constructing each of
+// its chunks from the corresponding argument; the arguments of tags are
+// ignored
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+template <class... Args>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::emplace(entity_type entity, Args &&... args)
+    -> iterator {
+  static_assert(sizeof...(Args) == sizeof...(ChunkTypes),
+                "An argument is needed for each chunk!");
+  assert(!has(entity));
+  size_type new_row = size();
+  emplace_back(entity, std::forward_as_tuple(std::forward<Args>(args)...),
+               stored_chunks{}, track_changes_t{});
+  try {
+    update_block_tick(new_row, track_changes_t{});
+    _mapping.insert(index(entity), new_row);
+  } catch (...) {
+    _storage.pop_back();
+    throw;
+  }
+  return iterator{new_row};
+}
+
+// removes `entity`, which has to be in the component, by moving the last row
+// in its place
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+void Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::erase(entity_type entity) {
+  size_type erased_row = row(entity);
+  size_type moved_row = _storage.erase_unordered(iterator{erased_row});
+  if (moved_row != erased_row) {
+    _mapping.insert(index(_storage.template at<0>(erased_row)), erased_row);
+    // the moved row keeps its tick, which its new block has to account for
+    update_block_tick(erased_row, track_changes_t{});
+  }
+  _mapping.erase(index(entity));
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+void Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::clear() noexcept {
+  _storage.clear();
+  _mapping.clear();
+  _changes.clear();
+}
+
+// the tick stamped on the rows changed now; it starts at 1, so all the rows
+// have changed since 0
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::tick() const noexcept -> tick_type {
+  static_assert(track_changes, "Changes aren't tracked!");
+  return _changes.tick;
+}
+
+// returns the current tick and moves to the next one, e.g. at the end of
+// a system, which then sees the later changes with `changed_since` the
+// returned tick
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::advance_tick() noexcept -> tick_type {
+  static_assert(track_changes, "Changes aren't tracked!");
+  return _changes.tick++;
+}
+
+// stamps the row as changed at the current tick; does nothing if changes
+// aren't tracked
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+void Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::mark_changed(iterator it) {
+  stamp(*it, track_changes_t{});
+}
+
+// the tick of the last change of the row
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::change_tick(iterator it) const -> tick_type {
+  static_assert(track_changes, "Changes aren't tracked!");
+  return _storage.template get<1>(it);
+}
+
+// the rows changed after the tick `since`
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::changed_since(tick_type since) const
+    -> changed_range {
+  static_assert(track_changes, "Changes aren't tracked!");
+  return changed_range{changed_iterator{this, next_changed(0, since), since},
+                       changed_iterator{this, size(), since}};
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+std::size_t
+Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+          ComponentTraits>::index(entity_type entity) noexcept {
+  return EntityTraits::index(entity);
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::row(entity_type entity) const noexcept
+    -> size_type {
+  size_type found = _mapping.find(index(entity));
+  assert(found != mapping_type::npos);
+  return found;
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+template <unsigned ChunkIndex>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::chunk(size_type row, std::false_type)
+    -> value_type<ChunkIndex> & {
+  return _storage.template at<column<ChunkIndex>::value>(row);
+}
+
+// tags have no state, so all the rows share a single one
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+template <unsigned ChunkIndex>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::chunk(size_type row, std::true_type)
+    -> value_type<ChunkIndex> & {
+  (void)row;
+  assert(row < size());
+  static value_type<ChunkIndex> tag;
+  return tag;
+}
+
+// appends a row of `entity` and the stored chunks, constructed from the
+// elements `J` of the tuple of forwarded arguments
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+template <class Tuple, std::size_t... J>
+void Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::emplace_back(entity_type entity, Tuple &&args,
+                                              tl::index_sequence<J...>,
+                                              std::false_type) {
+  _storage.emplace_back(entity, std::get<J>(std::move(args))...);
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+template <class Tuple, std::size_t... J>
+void Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::emplace_back(entity_type entity,
+                                              Tuple &&args,
+                                              tl::index_sequence<J...>,
+                                              std::true_type) {
+  _storage.emplace_back(entity, _changes.tick, std::get<J>(std::move(args))...);
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+void Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::stamp(size_type, std::false_type) noexcept {}
+
+// sets the tick of the row to the current one
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+void Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::stamp(size_type row, std::true_type) {
+  _storage.template at<1>(row) = _changes.tick;
+  update_block_tick(row, std::true_type{});
+}
+
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+void Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::update_block_tick(size_type,
+                                                   std::false_type) noexcept {}
+
+// raises the highest tick of the row's block to the tick of the row
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+void Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::update_block_tick(size_type row,
+                                                   std::true_type) {
+  std::vector<tick_type> &block_ticks = _changes.block_ticks;
+  std::size_t block = row / change_block_size;
+  if (block >= block_ticks.size()) {
+    block_ticks.resize(block + 1, 0);
+  }
+  tick_type tick = _storage.template at<1>(row);
+  if (block_ticks[block] < tick) {
+    block_ticks[block] = tick;
+  }
+}
+
+// the first row from `row` changed after `since`, or `size()`
+template <typename... ChunkTypes, class Mapping, class EntityTraits,
+          class ComponentTraits>
+auto Component<Chunks<ChunkTypes...>, Mapping, EntityTraits,
+               ComponentTraits>::next_changed(size_type row,
+                                              tick_type since) const noexcept
+    -> size_type {
+  const std::vector<tick_type> &block_ticks = _changes.block_ticks;
+  const tick_type *ticks = _storage.template data<1>();
+  size_type rows = size();
+  while (row < rows) {
+    std::size_t block = row / change_block_size;
+    size_type block_end = (block + 1) * change_block_size;
+    if (block_ticks[block] <= since) {
+      row = block_end;
+      continue;
+    }
+    for (; row < block_end && row < rows; ++row) {
+      if (ticks[row] > since) {
+        return row;
+      }
+    }
+  }
+  return rows;
+}
 }
@@ -1,3 +1,14 @@
 #pragma once
 
-namespace nete {}
+#include <cstddef>
+#include <cstdint>
+
+namespace nete {
+// describes the entity handles; components are addressed by the index of the
+// handle, so traits of handles with e.g. generation bits can strip them there
+struct DefaultEntityTraits {
+  using entity_type = std::uint32_t;
+
+  static std::size_t index(entity_type entity) noexcept { return entity; }
+};
+}
@@ -0,0 +1,509 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace nete {
+// maps entity indices to the rows of a component with a flat array; a lookup
+// is a single load, but the array is as long as the highest mapped index
+template <typename SizeType> class SparseArray {
+public:
+  using size_type = SizeType;
+
+  static constexpr size_type npos = static_cast<size_type>(-1);
+
+  size_type find(std::size_t index) const noexcept;
+  void insert(std::size_t index, size_type row);
+  void erase(std::size_t index) noexcept;
+  void clear() noexcept;
+
+private:
+  std::vector<size_type> _rows;
+};
+
+template <typename SizeType>
+constexpr typename SparseArray<SizeType>::size_type SparseArray<SizeType>::npos;
+
+// returns the row of `index`, or `npos` if it isn't mapped
+template <typename SizeType>
+auto SparseArray<SizeType>::find(std::size_t index) const noexcept
+    -> size_type {
+  return index < _rows.size() ? _rows[index] : npos;
+}
+
+// maps `index` to `row`, replacing its previous row, if any
+template <typename SizeType>
+void SparseArray<SizeType>::insert(std::size_t index, size_type row) {
+  if (index >= _rows.size()) {
+    _rows.resize(index + 1, npos);
+  }
+  _rows[index] = row;
+}
+
+template <typename SizeType>
+void SparseArray<SizeType>::erase(std::size_t index) noexcept {
+  _rows[index] = npos;
+}
+
+template <typename SizeType> void SparseArray<SizeType>::clear() noexcept {
+  _rows.clear();
+}
+
+// maps entity indices to rows with an array split into pages of `PageSize`
+// entries, which are allocated only when an index in their range is mapped;
+// the missing pages point to a shared page of `npos`. A lookup is a shift,
+// a mask and two loads, and the memory is proportional to the populated
+// ranges of indices.
+template <typename SizeType, std::size_t PageSize>
+class PagedSparseArray {
+public:
+  using size_type = SizeType;
+
+  static constexpr size_type npos = static_cast<size_type>(-1);
+  static constexpr std::size_t page_size = PageSize;
+
+  static_assert(page_size > 0 && (page_size & (page_size - 1)) == 0,
+                "The page size has to be a power of two!");
+
+  PagedSparseArray() = default;
+  PagedSparseArray(const PagedSparseArray &x);
+  PagedSparseArray(PagedSparseArray &&x) noexcept;
+  ~PagedSparseArray();
+
+  PagedSparseArray &operator=(const PagedSparseArray &x);
+  PagedSparseArray &operator=(PagedSparseArray &&x) noexcept;
+
+  size_type find(std::size_t index) const noexcept;
+  void insert(std::size_t index, size_type row);
+  void erase(std::size_t index) noexcept;
+  void clear() noexcept;
+
+  std::size_t page_count() const noexcept;
+
+private:
+  using page_type = std::array<size_type, page_size>;
+
+  static page_type *null_page() noexcept;
+
+  std::vector<page_type *> _pages;
+  // the number of mapped indices of each page, for freeing the empty ones
+  std::vector<size_type> _page_sizes;
+};
+
+template <typename SizeType, std::size_t PageSize>
+constexpr typename PagedSparseArray<SizeType, PageSize>::size_type
+    PagedSparseArray<SizeType, PageSize>::npos;
+
+template <typename SizeType, std::size_t PageSize>
+constexpr std::size_t PagedSparseArray<SizeType, PageSize>::page_size;
+
+template <typename SizeType, std::size_t PageSize>
+PagedSparseArray<SizeType, PageSize>::PagedSparseArray(
+    const PagedSparseArray &x)
+    : _pages(x._pages.size(), null_page()), _page_sizes(x._page_sizes) {
+  try {
+    for (std::size_t i = 0; i < _pages.size(); ++i) {
+      if (x._pages[i] != null_page()) {
+        _pages[i] = new page_type(*x._pages[i]);
+      }
+    }
+  } catch (...) {
+    clear();
+    throw;
+  }
+}
+
+template <typename SizeType, std::size_t PageSize>
+PagedSparseArray<SizeType, PageSize>::PagedSparseArray(
+    PagedSparseArray &&x) noexcept
+    : _pages(std::move(x._pages)), _page_sizes(std::move(x._page_sizes)) {
+  x._pages.clear();
+  x._page_sizes.clear();
+}
+
+template <typename SizeType, std::size_t PageSize>
+PagedSparseArray<SizeType, PageSize>::~PagedSparseArray() {
+  clear();
+}
+
+template <typename SizeType, std::size_t PageSize>
+auto PagedSparseArray<SizeType, PageSize>::operator=(
+    const PagedSparseArray &x) -> PagedSparseArray & {
+  PagedSparseArray tmp{x};
+  *this = std::move(tmp);
+  return *this;
+}
+
+template <typename SizeType, std::size_t PageSize>
+auto PagedSparseArray<SizeType, PageSize>::operator=(
+    PagedSparseArray &&x) noexcept -> PagedSparseArray & {
+  if (this != &x) {
+    clear();
+    _pages.swap(x._pages);
+    _page_sizes.swap(x._page_sizes);
+  }
+  return *this;
+}
+
+// returns the row of `index`, or `npos` if it isn't mapped
+template <typename SizeType, std::size_t PageSize>
+auto PagedSparseArray<SizeType, PageSize>::find(std::size_t index) const
+    noexcept -> size_type {
+  std::size_t page = index / page_size;
+  return page < _pages.size() ? (*_pages[page])[index % page_size] : npos;
+}
+
+// maps `index` to `row`, replacing its previous row, if any
+template <typename SizeType, std::size_t PageSize>
+void PagedSparseArray<SizeType, PageSize>::insert(std::size_t index,
+                                                  size_type row) {
+  std::size_t page = index / page_size;
+  if (page >= _pages.size()) {
+    // the sizes go first, so if growing the pages throws, the extra sizes
+    // are unused zeros rather than pages without a size
+    _page_sizes.resize(page + 1, 0);
+    _pages.resize(page + 1, null_page());
+  }
+  if (_pages[page] == null_page()) {
+    _pages[page] = new page_type(*null_page());
+  }
+  size_type &entry = (*_pages[page])[index % page_size];
+  if (entry == npos) {
+    ++_page_sizes[page];
+  }
+  entry = row;
+}
+
+// unmaps `index`, which has to be mapped, freeing its page if it's empty
+template <typename SizeType, std::size_t PageSize>
+void PagedSparseArray<SizeType, PageSize>::erase(std::size_t index) noexcept {
+  std::size_t page = index / page_size;
+  (*_pages[page])[index % page_size] = npos;
+  if (--_page_sizes[page] == 0) {
+    delete _pages[page];
+    _pages[page] = null_page();
+  }
+}
+
+template <typename SizeType, std::size_t PageSize>
+void PagedSparseArray<SizeType, PageSize>::clear() noexcept {
+  for (page_type *page : _pages) {
+    if (page != null_page()) {
+      delete page;
+    }
+  }
+  _pages.clear();
+  _page_sizes.clear();
+}
+
+// the number of allocated pages
+template <typename SizeType, std::size_t PageSize>
+std::size_t PagedSparseArray<SizeType, PageSize>::page_count() const noexcept {
+  return std::count_if(_pages.begin(), _pages.end(),
+                       [](page_type *page) { return page != null_page(); });
+}
+
+// the page of the unmapped ranges, shared by all the arrays of this type;
+// it is never written to
+template <typename SizeType, std::size_t PageSize>
+auto PagedSparseArray<SizeType, PageSize>::null_page() noexcept
+    -> page_type * {
+  static page_type page = [] {
+    page_type page;
+    page.fill(npos);
+    return page;
+  }();
+  return &page;
+}
+
+// the control bytes of a group of `FlatHashMap` slots, matched all at once;
+// bit `i` of a returned mask stands for the slot `i` of the group
+class HashMapGroup {
+public:
+  static constexpr std::size_t size = 16;
+
+  // a byte of a full slot holds 7 bits of the hash of its key
+  enum : std::int8_t { empty = -128, deleted = -2 };
+
+  explicit HashMapGroup(const std::int8_t *control) noexcept {
+#ifdef __SSE2__
+    _control = _mm_loadu_si128(reinterpret_cast<const __m128i *>(control));
+#else
+    std::memcpy(_control, control, size);
+#endif
+  }
+
+  // the slots whose control byte is `h2`
+  std::uint32_t match(std::int8_t h2) const noexcept {
+#ifdef __SSE2__
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), _control));
+#else
+    std::uint32_t mask = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+      mask |= std::uint32_t{_control[i] == h2} << i;
+    }
+    return mask;
+#endif
+  }
+
+  std::uint32_t match_empty() const noexcept { return match(empty); }
+
+  // the slots that are empty or deleted, which both have the sign bit set
+  std::uint32_t match_free() const noexcept {
+#ifdef __SSE2__
+    return _mm_movemask_epi8(_control);
+#else
+    std::uint32_t mask = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+      mask |= std::uint32_t{_control[i] < 0} << i;
+    }
+    return mask;
+#endif
+  }
+
+  // the index of the lowest slot of a non-empty mask
+  static std::size_t first(std::uint32_t mask) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#else
+    std::size_t i = 0;
+    for (; !(mask & 1); mask >>= 1) {
+      ++i;
+    }
+    return i;
+#endif
+  }
+
+private:
+#ifdef __SSE2__
+  __m128i _control;
+#else
+  std::int8_t _control[size];
+#endif
+};
+
+// maps entity indices to rows with an open addressing hash table in the style
+// of Swiss tables: the slots are probed a group at a time, by matching the
+// control bytes of the group against 7 bits of the hash with SIMD, and the
+// keys are compared only for the matching slots. The memory is proportional
+// to the number of mapped indices, for components of very few entities.
+template <typename SizeType> class FlatHashMap {
+public:
+  using size_type = SizeType;
+
+  static constexpr size_type npos = static_cast<size_type>(-1);
+
+  size_type find(std::size_t index) const noexcept;
+  void insert(std::size_t index, size_type row);
+  void erase(std::size_t index) noexcept;
+  void clear() noexcept;
+
+  std::size_t size() const noexcept;
+  std::size_t capacity() const noexcept;
+
+private:
+  struct slot_type {
+    std::size_t index;
+    size_type row;
+  };
+
+  static constexpr std::size_t group_size = HashMapGroup::size;
+  static constexpr std::size_t no_slot = static_cast<std::size_t>(-1);
+
+  static std::uint64_t hash(std::size_t index) noexcept;
+  static std::int8_t h2(std::uint64_t hash) noexcept;
+  std::size_t find_slot(std::size_t index, std::uint64_t hash) const noexcept;
+  std::size_t find_free_slot(std::uint64_t hash) const noexcept;
+  void rehash(std::size_t new_capacity);
+
+  // the capacity is a power of two multiple of the group size
+  std::vector<std::int8_t> _control;
+  std::vector<slot_type> _slots;
+  std::size_t _size = 0;
+  // the number of empty slots that can be filled before a rehash, which
+  // keeps the load factor at most 7/8, so each probe sequence ends
+  std::size_t _growth_left = 0;
+};
+
+template <typename SizeType>
+constexpr typename FlatHashMap<SizeType>::size_type FlatHashMap<SizeType>::npos;
+
+template <typename SizeType>
+constexpr std::size_t FlatHashMap<SizeType>::group_size;
+
+template <typename SizeType>
+constexpr std::size_t FlatHashMap<SizeType>::no_slot;
+
+// returns the row of `index`, or `npos` if it isn't mapped
+template <typename SizeType>
+auto FlatHashMap<SizeType>::find(std::size_t index) const noexcept
+    -> size_type {
+  std::size_t slot = find_slot(index, hash(index));
+  return slot != no_slot ? _slots[slot].row : npos;
+}
+
+// maps `index` to `row`, replacing its previous row, if any
+template <typename SizeType>
+void FlatHashMap<SizeType>::insert(std::size_t index, size_type row) {
+  std::uint64_t index_hash = hash(index);
+  std::size_t slot = find_slot(index, index_hash);
+  if (slot != no_slot) {
+    _slots[slot].row = row;
+    return;
+  }
+  slot = find_free_slot(index_hash);
+  if (slot == no_slot ||
+      (_control[slot] == HashMapGroup::empty && _growth_left == 0)) {
+    // grow unless the table is full mostly of deleted slots
+    std::size_t new_capacity = _size + 1 > capacity() * 7 / 16
+                                   ? std::max(capacity() * 2, group_size)
+                                   : capacity();
+    rehash(new_capacity);
+    slot = find_free_slot(index_hash);
+  }
+  if (_control[slot] == HashMapGroup::empty) {
+    --_growth_left;
+  }
+  _control[slot] = h2(index_hash);
+  _slots[slot] = slot_type{index, row};
+  ++_size;
+}
+
+// unmaps `index`, which has to be mapped; its slot is marked as deleted, so
+// the probe sequences passing it go on
+template <typename SizeType>
+void FlatHashMap<SizeType>::erase(std::size_t index) noexcept {
+  std::size_t slot = find_slot(index, hash(index));
+  _control[slot] = HashMapGroup::deleted;
+  --_size;
+}
+
+template <typename SizeType> void FlatHashMap<SizeType>::clear() noexcept {
+  _control.clear();
+  _control.shrink_to_fit();
+  _slots.clear();
+  _slots.shrink_to_fit();
+  _size = 0;
+  _growth_left = 0;
+}
+
+template <typename SizeType>
+std::size_t FlatHashMap<SizeType>::size() const noexcept {
+  return _size;
+}
+
+template <typename SizeType>
+std::size_t FlatHashMap<SizeType>::capacity() const noexcept {
+  return _slots.size();
+}
+
+// the finalizer of MurmurHash3, so that the consecutive indices are spread
+// over the whole table
+template <typename SizeType>
+std::uint64_t FlatHashMap<SizeType>::hash(std::size_t index) noexcept {
+  std::uint64_t h = index;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// the 7 bits of the hash stored in the control bytes; the remaining ones
+// select the first group to probe
+template <typename SizeType>
+std::int8_t FlatHashMap<SizeType>::h2(std::uint64_t hash) noexcept {
+  return static_cast<std::int8_t>(hash & 0x7f);
+}
+
+// the slot of `index`, or `no_slot`; the groups are probed quadratically,
+// which visits each of them when their number is a power of two
+template <typename SizeType>
+std::size_t FlatHashMap<SizeType>::find_slot(std::size_t index,
+                                             std::uint64_t hash) const
+    noexcept {
+  if (_slots.empty()) {
+    return no_slot;
+  }
+  std::size_t group_mask = capacity() / group_size - 1;
+  std::size_t group = (hash >> 7) & group_mask;
+  for (std::size_t step = 1;; ++step) {
+    HashMapGroup control{&_control[group * group_size]};
+    for (std::uint32_t mask = control.match(h2(hash)); mask;
+         mask &= mask - 1) {
+      std::size_t slot = group * group_size + HashMapGroup::first(mask);
+      if (_slots[slot].index == index) {
+        return slot;
+      }
+    }
+    if (control.match_empty()) {
+      return no_slot;
+    }
+    group = (group + step) & group_mask;
+  }
+}
+
+// the first empty or deleted slot in the probe sequence of `hash`, or
+// `no_slot` if the table has no slots
+template <typename SizeType>
+std::size_t FlatHashMap<SizeType>::find_free_slot(std::uint64_t hash) const
+    noexcept {
+  if (_slots.empty()) {
+    return no_slot;
+  }
+  std::size_t group_mask = capacity() / group_size - 1;
+  std::size_t group = (hash >> 7) & group_mask;
+  for (std::size_t step = 1;; ++step) {
+    std::uint32_t mask =
+        HashMapGroup{&_control[group * group_size]}.match_free();
+    if (mask) {
+      return group * group_size + HashMapGroup::first(mask);
+    }
+    group = (group + step) & group_mask;
+  }
+}
+
+// moves the mapped indices to a table of `new_capacity` slots, dropping the
+// deleted slots
+template <typename SizeType>
+void FlatHashMap<SizeType>::rehash(std::size_t new_capacity) {
+  std::vector<std::int8_t> control(new_capacity, HashMapGroup::empty);
+  std::vector<slot_type> slots(new_capacity);
+  _control.swap(control);
+  _slots.swap(slots);
+  _growth_left = new_capacity - new_capacity / 8 - _size;
+  for (std::size_t i = 0; i < control.size(); ++i) {
+    if (control[i] >= 0) {
+      std::uint64_t index_hash = hash(slots[i].index);
+      std::size_t slot = find_free_slot(index_hash);
+      _control[slot] = h2(index_hash);
+      _slots[slot] = slots[i];
+    }
+  }
+}
+
+// the `Mapping` policies of `Component` name the entity index to row mapping
+// for the component's size type
+struct SparseArrayMapping {
+  template <typename SizeType> using mapping_type = SparseArray<SizeType>;
+};
+
+template <std::size_t PageSize = 4096> struct PagedSparseArrayMapping {
+  template <typename SizeType>
+  using mapping_type = PagedSparseArray<SizeType, PageSize>;
+};
+
+struct FlatHashMapMapping {
+  template <typename SizeType> using mapping_type = FlatHashMap<SizeType>;
+};
+}
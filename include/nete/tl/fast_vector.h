@@ -1,5 +1,11 @@
 #pragma once
 
+#include "memory.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -86,45 +92,99 @@ private:
   T *_ptr;
 };
 
+// capacity growth policy: the capacity is multiplied by
+// `Numerator / Denominator`, but never grows to less than `MinCapacity`
+template <std::size_t Numerator = 2, std::size_t Denominator = 1,
+          std::size_t MinCapacity = 8>
+struct geometric_growth {
+  static_assert(Denominator > 0 && Numerator > Denominator,
+                "Growth factor must be greater than 1!");
+
+  template <typename SizeType>
+  static SizeType next_capacity(SizeType capacity, SizeType required_capacity) {
+    SizeType grown_capacity =
+        capacity + capacity / Denominator * (Numerator - Denominator) +
+        capacity % Denominator * (Numerator - Denominator) / Denominator;
+    return std::max(std::max(grown_capacity, required_capacity),
+                    static_cast<SizeType>(MinCapacity));
+  }
+};
+
 template <typename T, class Allocator> struct fast_vector_base {
   using allocator_type = Allocator;
   using size_type = std::size_t;
 
-  fast_vector_base(const allocator_type &alloc, size_type size)
-      : _allocator(alloc), _data(size ? _allocator.allocate(size) : nullptr),
-        _size(size) {}
+  fast_vector_base(const allocator_type &alloc, size_type capacity)
+      : _allocator(alloc),
+        _data(capacity ? _allocator.allocate(capacity) : nullptr), _size(0),
+        _capacity(capacity) {}
 
   ~fast_vector_base() {
-    if (_size) {
-      _allocator.deallocate(_data, _size);
+    if (_capacity) {
+      _allocator.deallocate(_data, _capacity);
     }
   }
 
   fast_vector_base(fast_vector_base &&x)
-      : _allocator(std::move(x._allocator)), _data(x._data), _size(x._size) {
+      : _allocator(std::move(x._allocator)), _data(x._data), _size(x._size),
+        _capacity(x._capacity) {
     x._data = nullptr;
     x._size = 0;
+    x._capacity = 0;
   };
 
   fast_vector_base &operator=(fast_vector_base &&x) {
     std::swap(_allocator, x._allocator);
     std::swap(_data, x._data);
     std::swap(_size, x._size);
+    std::swap(_capacity, x._capacity);
     return *this;
   };
 
   fast_vector_base(const fast_vector_base &x) = delete;
   fast_vector_base &operator=(const fast_vector_base &x) = delete;
 
+  // changes the capacity, keeping the first `min(_size, new_capacity)` elements
+  void reallocate(size_type new_capacity) {
+    using relocation_t =
+        typename std::conditional<allocator_has_reallocate<Allocator>::value,
+                                  in_place_relocation_t,
+                                  move_relocation_t>::type;
+    if (_capacity && new_capacity) {
+      reallocate(new_capacity, relocation_t{});
+    } else {
+      reallocate(new_capacity, move_relocation_t{});
+    }
+  }
+
+  void reallocate(size_type new_capacity, move_relocation_t) {
+    fast_vector_base new_base{_allocator, new_capacity};
+    new_base._size = std::min(_size, new_capacity);
+    if (new_base._size) {
+      std::memcpy(new_base._data, _data, sizeof(T) * new_base._size);
+    }
+    std::swap(*this, new_base);
+  }
+
+  void reallocate(size_type new_capacity, in_place_relocation_t) {
+    _data = _allocator.reallocate(_data, _capacity, new_capacity);
+    _capacity = new_capacity;
+    _size = std::min(_size, new_capacity);
+  }
+
   allocator_type _allocator;
   T *_data;
   size_type _size;
+  size_type _capacity;
 };
 
-template <typename T, class Allocator = std::allocator<T>> class fast_vector {
+template <typename T, class Allocator = std::allocator<T>,
+          class GrowthPolicy = geometric_growth<>>
+class fast_vector {
 public:
   using value_type = T;
   using allocator_type = Allocator;
+  using growth_policy = GrowthPolicy;
   using reference = value_type &;
   using const_reference = const value_type &;
   using size_type = std::size_t;
@@ -162,6 +222,9 @@ public:
 
   bool empty() const noexcept;
   size_type size() const noexcept;
+  void reserve(size_type requested_capacity);
+  size_type capacity() const noexcept;
+  void shrink_to_fit();
 
   void clear() noexcept;
   void push_back(const value_type &val);
@@ -169,137 +232,254 @@ public:
   void pop_back();
   void resize(size_type requested_size);
   void resize(size_type requested_size, const value_type &val);
+  void resize_uninitialized(size_type requested_size);
+  void append(const_pointer values, size_type count);
+  iterator insert(iterator position, const_pointer first, const_pointer last);
 
 private:
+  void reallocate(size_type new_capacity);
+  void grow(size_type required_capacity);
+
   fast_vector_base_type _base;
 };
 
-template <typename T, class Allocator>
-fast_vector<T, Allocator>::fast_vector(const allocator_type &alloc)
+// appends `count` elements copied from `values` to `v`, a fast_vector or a
+// small_fast_vector; `values` may point into `v`
+template <class Vector>
+void fast_vector_append(Vector &v, typename Vector::const_pointer values,
+                        typename Vector::size_type count) {
+  using size_type = typename Vector::size_type;
+  using const_pointer = typename Vector::const_pointer;
+  size_type old_size = v.size();
+  if (old_size + count > v.capacity()) {
+    // `values` may point into the buffer that is about to be moved
+    std::less<const_pointer> less;
+    const_pointer data = v.data();
+    bool own_values = !less(values, data) && less(values, data + old_size);
+    size_type values_offset = 0;
+    if (own_values) {
+      values_offset = static_cast<size_type>(values - data);
+    }
+    v.reserve(Vector::growth_policy::next_capacity(v.capacity(),
+                                                   old_size + count));
+    if (own_values) {
+      values = v.data() + values_offset;
+    }
+  }
+  v.resize_uninitialized(old_size + count);
+  if (count) {
+    std::memcpy(v.data() + old_size, values,
+                sizeof(typename Vector::value_type) * count);
+  }
+}
+
+// inserts the elements [first, last) in `v`, a fast_vector or a
+// small_fast_vector, before `position`, moving the following elements with a
+// single `memmove`; returns the iterator to the first inserted element
+template <class Vector>
+auto fast_vector_insert(Vector &v, typename Vector::iterator position,
+                        typename Vector::const_pointer first,
+                        typename Vector::const_pointer last)
+    -> typename Vector::iterator {
+  using value_type = typename Vector::value_type;
+  using size_type = typename Vector::size_type;
+  using const_pointer = typename Vector::const_pointer;
+  size_type index = position - v.begin();
+  size_type count = last - first;
+  assert(index <= v.size());
+  std::less<const_pointer> less;
+  const_pointer data = v.data();
+  if (less(first, data + v.size()) && less(data, last)) {
+    // the elements to insert are moved by the insertion, copy them first
+    fast_vector<value_type, typename Vector::allocator_type> values{
+        v.get_allocator()};
+    values.append(first, count);
+    return fast_vector_insert(v, v.begin() + index, values.data(),
+                              values.data() + count);
+  }
+  size_type old_size = v.size();
+  if (old_size + count > v.capacity()) {
+    v.reserve(Vector::growth_policy::next_capacity(v.capacity(),
+                                                   old_size + count));
+  }
+  v.resize_uninitialized(old_size + count);
+  if (count) {
+    std::memmove(v.data() + index + count, v.data() + index,
+                 sizeof(value_type) * (old_size - index));
+    std::memcpy(v.data() + index, first, sizeof(value_type) * count);
+  }
+  return v.begin() + index;
+}
+
+template <typename T, class Allocator, class GrowthPolicy>
+fast_vector<T, Allocator, GrowthPolicy>::fast_vector(
+    const allocator_type &alloc)
     : _base(alloc, 0) {}
 
-template <typename T, class Allocator>
-fast_vector<T, Allocator>::fast_vector(size_type size, const value_type &val,
-                                       const allocator_type &alloc)
+template <typename T, class Allocator, class GrowthPolicy>
+fast_vector<T, Allocator, GrowthPolicy>::fast_vector(
+    size_type size, const value_type &val, const allocator_type &alloc)
     : _base{alloc, size} {
+  _base._size = size;
   std::fill(_base._data, _base._data + _base._size, val);
 }
 
-template <typename T, class Allocator>
-fast_vector<T, Allocator>::fast_vector(size_type size,
-                                       const allocator_type &alloc)
-    : _base{alloc, size} {}
+template <typename T, class Allocator, class GrowthPolicy>
+fast_vector<T, Allocator, GrowthPolicy>::fast_vector(
+    size_type size, const allocator_type &alloc)
+    : _base{alloc, size} {
+  _base._size = size;
+}
 
-template <typename T, class Allocator>
-fast_vector<T, Allocator>::fast_vector(const fast_vector &x)
+template <typename T, class Allocator, class GrowthPolicy>
+fast_vector<T, Allocator, GrowthPolicy>::fast_vector(const fast_vector &x)
     : _base{x.get_allocator(), x.size()} {
+  _base._size = x.size();
   std::memcpy(data(), x.data(), sizeof(T) * size());
 }
 
-template <typename T, class Allocator>
-auto fast_vector<T, Allocator>::operator=(const fast_vector &x)
+template <typename T, class Allocator, class GrowthPolicy>
+auto fast_vector<T, Allocator, GrowthPolicy>::operator=(const fast_vector &x)
     -> fast_vector & {
   fast_vector tmp{x};
   std::swap(*this, tmp);
   return *this;
 }
 
-template <typename T, class Allocator>
-auto fast_vector<T, Allocator>::operator=(fast_vector &&x) -> fast_vector & {
+template <typename T, class Allocator, class GrowthPolicy>
+auto fast_vector<T, Allocator, GrowthPolicy>::operator=(fast_vector &&x)
+    -> fast_vector & {
   clear();
   std::swap(_base, x._base);
   return *this;
 };
 
-template <typename T, class Allocator>
-auto fast_vector<T, Allocator>::get_allocator() const noexcept
+template <typename T, class Allocator, class GrowthPolicy>
+auto fast_vector<T, Allocator, GrowthPolicy>::get_allocator() const noexcept
     -> allocator_type {
   return _base._allocator;
 }
 
-template <typename T, class Allocator>
-auto fast_vector<T, Allocator>::at(size_type i) -> reference {
+template <typename T, class Allocator, class GrowthPolicy>
+auto fast_vector<T, Allocator, GrowthPolicy>::at(size_type i) -> reference {
   return _base._data[i];
 }
 
-template <typename T, class Allocator>
-auto fast_vector<T, Allocator>::at(size_type i) const -> const_reference {
+template <typename T, class Allocator, class GrowthPolicy>
+auto fast_vector<T, Allocator, GrowthPolicy>::at(size_type i) const
+    -> const_reference {
   return _base._data[i];
 }
 
-template <typename T, class Allocator>
-auto fast_vector<T, Allocator>::data() noexcept -> pointer {
+template <typename T, class Allocator, class GrowthPolicy>
+auto fast_vector<T, Allocator, GrowthPolicy>::data() noexcept -> pointer {
   return _base._data;
 }
 
-template <typename T, class Allocator>
-auto fast_vector<T, Allocator>::data() const noexcept -> const_pointer {
+template <typename T, class Allocator, class GrowthPolicy>
+auto fast_vector<T, Allocator, GrowthPolicy>::data() const noexcept
+    -> const_pointer {
   return _base._data;
 }
 
-template <typename T, class Allocator>
-auto fast_vector<T, Allocator>::begin() noexcept -> iterator {
+template <typename T, class Allocator, class GrowthPolicy>
+auto fast_vector<T, Allocator, GrowthPolicy>::begin() noexcept -> iterator {
   return iterator{data()};
   ;
 }
 
-template <typename T, class Allocator>
-auto fast_vector<T, Allocator>::end() noexcept -> iterator {
+template <typename T, class Allocator, class GrowthPolicy>
+auto fast_vector<T, Allocator, GrowthPolicy>::end() noexcept -> iterator {
   return iterator{data() + size()};
   ;
 }
 
-template <typename T, class Allocator>
-auto fast_vector<T, Allocator>::rbegin() noexcept -> reverse_iterator {
+template <typename T, class Allocator, class GrowthPolicy>
+auto fast_vector<T, Allocator, GrowthPolicy>::rbegin() noexcept
+    -> reverse_iterator {
   return std::reverse_iterator<iterator>{end()};
 }
 
-template <typename T, class Allocator>
-auto fast_vector<T, Allocator>::rend() noexcept -> reverse_iterator {
+template <typename T, class Allocator, class GrowthPolicy>
+auto fast_vector<T, Allocator, GrowthPolicy>::rend() noexcept
+    -> reverse_iterator {
   return std::reverse_iterator<iterator>{begin()};
 }
 
-template <typename T, class Allocator>
-bool fast_vector<T, Allocator>::empty() const noexcept {
+template <typename T, class Allocator, class GrowthPolicy>
+bool fast_vector<T, Allocator, GrowthPolicy>::empty() const noexcept {
   return size() == 0;
 }
 
-template <typename T, class Allocator>
-auto fast_vector<T, Allocator>::size() const noexcept -> size_type {
+template <typename T, class Allocator, class GrowthPolicy>
+auto fast_vector<T, Allocator, GrowthPolicy>::size() const noexcept
+    -> size_type {
   return _base._size;
 }
 
-template <typename T, class Allocator>
-void fast_vector<T, Allocator>::clear() noexcept {
-  resize(0);
+template <typename T, class Allocator, class GrowthPolicy>
+void fast_vector<T, Allocator, GrowthPolicy>::reserve(
+    size_type requested_capacity) {
+  if (requested_capacity > capacity()) {
+    reallocate(requested_capacity);
+  }
+}
+
+template <typename T, class Allocator, class GrowthPolicy>
+auto fast_vector<T, Allocator, GrowthPolicy>::capacity() const noexcept
+    -> size_type {
+  return _base._capacity;
 }
 
-template <typename T, class Allocator>
-void fast_vector<T, Allocator>::push_back(const value_type &val) {
-  resize(size() + 1, val);
+template <typename T, class Allocator, class GrowthPolicy>
+void fast_vector<T, Allocator, GrowthPolicy>::shrink_to_fit() {
+  if (size() < capacity()) {
+    reallocate(size());
+  }
+}
+
+template <typename T, class Allocator, class GrowthPolicy>
+void fast_vector<T, Allocator, GrowthPolicy>::clear() noexcept {
+  _base._size = 0;
+}
+
+template <typename T, class Allocator, class GrowthPolicy>
+void fast_vector<T, Allocator, GrowthPolicy>::push_back(
+    const value_type &val) {
+  if (size() == capacity()) {
+    // `val` may point into the buffer that is about to be released
+    value_type val_copy = val;
+    grow(size() + 1);
+    _base._data[_base._size++] = val_copy;
+  } else {
+    _base._data[_base._size++] = val;
+  }
 }
 
-template <typename T, class Allocator>
-void fast_vector<T, Allocator>::emplace_back() {
-  resize(size() + 1);
+template <typename T, class Allocator, class GrowthPolicy>
+void fast_vector<T, Allocator, GrowthPolicy>::emplace_back() {
+  if (size() == capacity()) {
+    grow(size() + 1);
+  }
+  ++_base._size;
 }
 
-template <typename T, class Allocator>
-void fast_vector<T, Allocator>::pop_back() {
-  resize(size() - 1);
+template <typename T, class Allocator, class GrowthPolicy>
+void fast_vector<T, Allocator, GrowthPolicy>::pop_back() {
+  assert(!empty());
+  --_base._size;
 }
 
-template <typename T, class Allocator>
-void fast_vector<T, Allocator>::resize(size_type requested_size) {
-  fast_vector_base_type new_base{get_allocator(), requested_size};
-  auto min_size = std::min(size(), requested_size);
-  std::memcpy(new_base._data, data(), sizeof(T) * min_size);
-  std::swap(_base, new_base);
+template <typename T, class Allocator, class GrowthPolicy>
+void fast_vector<T, Allocator, GrowthPolicy>::resize(
+    size_type requested_size) {
+  reserve(requested_size);
+  _base._size = requested_size;
 }
 
-template <typename T, class Allocator>
-void fast_vector<T, Allocator>::resize(size_type requested_size,
-                                       const value_type &val) {
+template <typename T, class Allocator, class GrowthPolicy>
+void fast_vector<T, Allocator, GrowthPolicy>::resize(size_type requested_size,
+                                                     const value_type &val) {
   auto old_size = size();
   resize(requested_size);
   if (requested_size > old_size) {
@@ -307,5 +487,43 @@ void fast_vector<T, Allocator>::resize(size_type requested_size,
   }
 }
 
+// the new elements are left uninitialized, e.g. to be written by a read from a
+// file or a socket
+template <typename T, class Allocator, class GrowthPolicy>
+void fast_vector<T, Allocator, GrowthPolicy>::resize_uninitialized(
+    size_type requested_size) {
+  resize(requested_size);
+}
+
+// appends `count` elements copied from `values`, which may point into this
+// vector
+template <typename T, class Allocator, class GrowthPolicy>
+void fast_vector<T, Allocator, GrowthPolicy>::append(const_pointer values,
+                                                     size_type count) {
+  fast_vector_append(*this, values, count);
+}
+
+// inserts the elements [first, last), which may point into this vector,
+// before `position`; returns the iterator to the first inserted element
+template <typename T, class Allocator, class GrowthPolicy>
+auto fast_vector<T, Allocator, GrowthPolicy>::insert(iterator position,
+                                                     const_pointer first,
+                                                     const_pointer last)
+    -> iterator {
+  return fast_vector_insert(*this, position, first, last);
+}
+
+template <typename T, class Allocator, class GrowthPolicy>
+void fast_vector<T, Allocator, GrowthPolicy>::reallocate(
+    size_type new_capacity) {
+  _base.reallocate(new_capacity);
+}
+
+template <typename T, class Allocator, class GrowthPolicy>
+void fast_vector<T, Allocator, GrowthPolicy>::grow(
+    size_type required_capacity) {
+  reallocate(growth_policy::next_capacity(capacity(), required_capacity));
+}
+
 } // namespace tl
 } // namespace nete
@@ -0,0 +1,562 @@
+#pragma once
+
+#include "multivector.h"
+#include "type_traits.h"
+#include "utility.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+namespace nete {
+namespace tl {
+
+// a group of columns with its own traits, e.g. its own allocator or growth
+// policy
+template <typename Types, class Traits> struct group {};
+
+// a list of column groups, each given as `types<...>` or `group<...>`. A
+// multivector of groups keeps every group in a separate allocation, which
+// grows on its own, so e.g. rarely accessed columns aren't moved and cached
+// together with the frequently accessed ones.
+template <typename... G> struct groups {};
+
+template <typename G, class DefaultTraits> struct group_of {
+  using value_types = G;
+  using traits = DefaultTraits;
+};
+
+template <typename Types, class Traits, class DefaultTraits>
+struct group_of<group<Types, Traits>, DefaultTraits> {
+  using value_types = Types;
+  using traits = Traits;
+};
+
+template <typename... Types> struct concat_types;
+
+template <typename... T> struct concat_types<types<T...>> {
+  using type = types<T...>;
+};
+
+template <typename... T, typename... U, typename... Tail>
+struct concat_types<types<T...>, types<U...>, Tail...>
+    : concat_types<types<T..., U...>, Tail...> {};
+
+// the types of the columns of all the groups
+template <class Traits, typename... G> struct grouped_value_types {
+  using type =
+      typename concat_types<typename group_of<G, Traits>::value_types...>::type;
+};
+
+template <std::size_t Group, std::size_t Index> struct located_column {
+  static constexpr std::size_t group = Group;
+  static constexpr std::size_t index = Index;
+};
+
+// the group of the column `I` and its index in that group, given the sizes of
+// the groups
+template <std::size_t I, std::size_t Group, std::size_t... Sizes>
+struct locate_column;
+
+template <std::size_t I, std::size_t Group, std::size_t Head,
+          std::size_t... Tail>
+struct locate_column<I, Group, Head, Tail...>
+    : std::conditional<(I < Head), located_column<Group, I>,
+                       locate_column<I - Head, Group + 1, Tail...>>::type {};
+
+// the sum of the first `K` of `Sizes`
+template <std::size_t K, std::size_t... Sizes> struct sum_of_first;
+
+template <std::size_t Head, std::size_t... Tail>
+struct sum_of_first<0, Head, Tail...>
+    : std::integral_constant<std::size_t, 0> {};
+
+template <std::size_t K, std::size_t Head, std::size_t... Tail>
+struct sum_of_first<K, Head, Tail...>
+    : std::integral_constant<std::size_t,
+                             Head + sum_of_first<K - 1, Tail...>::value> {};
+
+template <typename Groups, typename Types, class Traits>
+class grouped_multivector;
+
+// the implementation of `multivector<groups<G...>, Traits>`, where `T...` are
+// the types of all the columns, group after group. The columns are indexed
+// across the groups, and every group is a multivector of its own, accessible
+// with `group<K>()`.
+template <typename... G, typename... T, class Traits>
+class grouped_multivector<groups<G...>, types<T...>, Traits> {
+public:
+  template <std::size_t I> using value_type = nth_type_of<I, T...>;
+  using value_types = types<T...>;
+  using groups_tuple =
+      std::tuple<multivector<typename group_of<G, Traits>::value_types,
+                             typename group_of<G, Traits>::traits>...>;
+  template <std::size_t K>
+  using group_type = typename std::tuple_element<K, groups_tuple>::type;
+  template <std::size_t I> using reference = value_type<I> &;
+  template <std::size_t I> using const_reference = const value_type<I> &;
+  using size_type = typename Traits::size_type;
+  using iterator = multivector_iterator<grouped_multivector>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  template <std::size_t... I>
+  using zip_range = multivector_zip_range<value_type<I>...>;
+  template <std::size_t... I>
+  using const_zip_range = multivector_zip_range<const value_type<I>...>;
+  template <std::size_t... I>
+  using view_type = multivector_view<value_type<I>...>;
+  template <std::size_t... I>
+  using const_view_type = multivector_view<const value_type<I>...>;
+  template <std::size_t I> using pointer = value_type<I> *;
+  template <std::size_t I> using const_pointer = const value_type<I> *;
+
+  static constexpr std::size_t value_types_size = value_types::size;
+  static constexpr std::size_t groups_size = sizeof...(G);
+
+  static_assert(value_types_size > 0, "");
+
+  grouped_multivector() = default;
+  explicit grouped_multivector(size_type size);
+  grouped_multivector(size_type size, const T &... values);
+
+  template <std::size_t K> group_type<K> &group() noexcept;
+  template <std::size_t K> const group_type<K> &group() const noexcept;
+
+  template <std::size_t I> reference<I> at(size_type i);
+  template <std::size_t I> const_reference<I> at(size_type i) const;
+  template <std::size_t I> reference<I> get(iterator it);
+  template <std::size_t I> const_reference<I> get(iterator it) const;
+  template <std::size_t I> reference<I> get(reverse_iterator rit);
+  template <std::size_t I> const_reference<I> get(reverse_iterator rit) const;
+  template <std::size_t I> pointer<I> data() noexcept;
+  template <std::size_t I> const_pointer<I> data() const noexcept;
+
+  iterator begin() noexcept;
+  iterator end() noexcept;
+  reverse_iterator rbegin() noexcept;
+  reverse_iterator rend() noexcept;
+  template <std::size_t... I> zip_range<I...> zip() noexcept;
+  template <std::size_t... I> const_zip_range<I...> zip() const noexcept;
+  template <std::size_t... I> view_type<I...> view() noexcept;
+  template <std::size_t... I> const_view_type<I...> view() const noexcept;
+
+  bool empty() const noexcept;
+  size_type size() const noexcept;
+  void reserve(size_type requested_capacity);
+  size_type capacity() const noexcept;
+  void shrink_to_fit();
+
+  void clear() noexcept;
+  void push_back(const T &... values);
+  void emplace_back();
+  void pop_back();
+  void resize(size_type requested_size);
+  void resize(size_type requested_size, const T &... values);
+  void swap(iterator first, iterator second);
+  size_type erase_unordered(iterator position);
+
+private:
+  template <std::size_t I>
+  using location =
+      locate_column<I, 0, group_of<G, Traits>::value_types::size...>;
+  template <std::size_t K>
+  using group_offset =
+      sum_of_first<K, group_of<G, Traits>::value_types::size...>;
+  template <std::size_t K>
+  using group_index = std::integral_constant<std::size_t, K>;
+  using values_tuple = std::tuple<const T &...>;
+
+  template <std::size_t K, std::size_t... J>
+  void push_back_group(const values_tuple &values, index_sequence<J...>);
+  template <std::size_t K, std::size_t... J>
+  void resize_group(size_type requested_size, const values_tuple &values,
+                    index_sequence<J...>);
+  void push_back_groups(const values_tuple &values, group_index<groups_size>);
+  template <std::size_t K>
+  void push_back_groups(const values_tuple &values, group_index<K>);
+  void emplace_back_groups(group_index<groups_size>);
+  template <std::size_t K> void emplace_back_groups(group_index<K>);
+  void resize_groups(size_type requested_size, const values_tuple &values,
+                     group_index<groups_size>);
+  template <std::size_t K>
+  void resize_groups(size_type requested_size, const values_tuple &values,
+                     group_index<K>);
+  template <std::size_t... K>
+  size_type capacity(index_sequence<K...>) const noexcept;
+  template <class F> void for_each_group(F f);
+  template <class F, std::size_t... K>
+  void for_each_group(F &f, index_sequence<K...>);
+
+  struct reserve_group {
+    size_type capacity;
+    template <class M> void operator()(M &m) const { m.reserve(capacity); }
+  };
+  struct shrink_group {
+    template <class M> void operator()(M &m) const { m.shrink_to_fit(); }
+  };
+  struct resize_group_rows {
+    size_type size;
+    template <class M> void operator()(M &m) const { m.resize(size); }
+  };
+  struct pop_back_group {
+    template <class M> void operator()(M &m) const { m.pop_back(); }
+  };
+  struct swap_group_rows {
+    size_type first, second;
+    template <class M> void operator()(M &m) const {
+      m.swap(typename M::iterator{first}, typename M::iterator{second});
+    }
+  };
+  struct erase_group_row {
+    size_type position;
+    template <class M> void operator()(M &m) const {
+      m.erase_unordered(typename M::iterator{position});
+    }
+  };
+
+  groups_tuple _groups;
+};
+
+template <typename... G, typename... T, class Traits>
+grouped_multivector<groups<G...>, types<T...>, Traits>::grouped_multivector(
+    size_type size) {
+  resize(size);
+}
+
+template <typename... G, typename... T, class Traits>
+grouped_multivector<groups<G...>, types<T...>, Traits>::grouped_multivector(
+    size_type size, const T &... values) {
+  resize(size, values...);
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t K>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::group() noexcept
+    -> group_type<K> & {
+  return std::get<K>(_groups);
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t K>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::group() const
+    noexcept -> const group_type<K> & {
+  return std::get<K>(_groups);
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t I>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::at(size_type i)
+    -> reference<I> {
+  return get<I>(iterator{i});
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t I>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::at(
+    size_type i) const -> const_reference<I> {
+  return get<I>(iterator{i});
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t I>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::get(iterator it)
+    -> reference<I> {
+  size_type index = *it;
+  assert(index < size());
+  return *(data<I>() + index);
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t I>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::get(
+    iterator it) const -> const_reference<I> {
+  return const_cast<grouped_multivector *>(this)->template get<I>(it);
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t I>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::get(
+    reverse_iterator rit) -> reference<I> {
+  return get<I>(rit.base() - 1);
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t I>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::get(
+    reverse_iterator rit) const -> const_reference<I> {
+  return const_cast<grouped_multivector *>(this)->template get<I>(rit);
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t I>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::data() noexcept
+    -> pointer<I> {
+  return group<location<I>::group>().template data<location<I>::index>();
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t I>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::data() const
+    noexcept -> const_pointer<I> {
+  return group<location<I>::group>().template data<location<I>::index>();
+}
+
+template <typename... G, typename... T, class Traits>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::begin() noexcept
+    -> iterator {
+  return iterator{0};
+}
+
+template <typename... G, typename... T, class Traits>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::end() noexcept
+    -> iterator {
+  return iterator{size()};
+}
+
+template <typename... G, typename... T, class Traits>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::rbegin() noexcept
+    -> reverse_iterator {
+  return std::reverse_iterator<iterator>{end()};
+}
+
+template <typename... G, typename... T, class Traits>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::rend() noexcept
+    -> reverse_iterator {
+  return std::reverse_iterator<iterator>{begin()};
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t... I>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::zip() noexcept
+    -> zip_range<I...> {
+  return zip_range<I...>{std::make_tuple(data<I>()...), size()};
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t... I>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::zip() const
+    noexcept -> const_zip_range<I...> {
+  return const_zip_range<I...>{std::make_tuple(data<I>()...), size()};
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t... I>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::view() noexcept
+    -> view_type<I...> {
+  // the columns of a view are accessed through restrict-qualified pointers
+  static_assert(constexpr_distinct(I...),
+                "A mutable view cannot contain a column more than once!");
+  return view_type<I...>{std::make_tuple(data<I>()...), size()};
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t... I>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::view() const
+    noexcept -> const_view_type<I...> {
+  return const_view_type<I...>{std::make_tuple(data<I>()...), size()};
+}
+
+template <typename... G, typename... T, class Traits>
+bool grouped_multivector<groups<G...>, types<T...>, Traits>::empty() const
+    noexcept {
+  return size() == 0;
+}
+
+template <typename... G, typename... T, class Traits>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::size() const
+    noexcept -> size_type {
+  return group<0>().size();
+}
+
+template <typename... G, typename... T, class Traits>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::reserve(
+    size_type requested_capacity) {
+  for_each_group(reserve_group{requested_capacity});
+}
+
+// the number of rows that fit in every group
+template <typename... G, typename... T, class Traits>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::capacity() const
+    noexcept -> size_type {
+  return capacity(make_index_sequence<groups_size>{});
+}
+
+template <typename... G, typename... T, class Traits>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::shrink_to_fit() {
+  for_each_group(shrink_group{});
+}
+
+template <typename... G, typename... T, class Traits>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::clear() noexcept {
+  resize(0);
+}
+
+// each group grows according to its own policy; if a group fails to grow, the
+// row is removed from the groups it was already added to
+template <typename... G, typename... T, class Traits>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::push_back(
+    const T &... values) {
+  // the values may be rows of this multivector, in a group that grows before
+  // the one they are copied to
+  std::tuple<T...> values_copy{values...};
+  const values_tuple &values_copy_refs = values_copy;
+  push_back_groups(values_copy_refs, group_index<0>{});
+}
+
+template <typename... G, typename... T, class Traits>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::emplace_back() {
+  emplace_back_groups(group_index<0>{});
+}
+
+template <typename... G, typename... T, class Traits>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::pop_back() {
+  assert(!empty());
+  for_each_group(pop_back_group{});
+}
+
+template <typename... G, typename... T, class Traits>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::resize(
+    size_type requested_size) {
+  for_each_group(resize_group_rows{requested_size});
+}
+
+template <typename... G, typename... T, class Traits>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::resize(
+    size_type requested_size, const T &... values) {
+  if (requested_size <= size()) {
+    resize(requested_size);
+    return;
+  }
+  // the values may be rows of this multivector, in any of the groups
+  std::tuple<T...> values_copy{values...};
+  const values_tuple &values_copy_refs = values_copy;
+  resize_groups(requested_size, values_copy_refs, group_index<0>{});
+}
+
+template <typename... G, typename... T, class Traits>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::swap(
+    iterator first, iterator second) {
+  for_each_group(swap_group_rows{*first, *second});
+}
+
+// erases the row at `position` by moving the last row in its place, like
+// `multivector::erase_unordered`
+template <typename... G, typename... T, class Traits>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::erase_unordered(
+    iterator position) -> size_type {
+  assert(*position < size());
+  size_type last_index = size() - 1;
+  for_each_group(erase_group_row{*position});
+  return last_index;
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t K, std::size_t... J>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::push_back_group(
+    const values_tuple &values, index_sequence<J...>) {
+  group<K>().push_back(std::get<group_offset<K>::value + J>(values)...);
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t K, std::size_t... J>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::resize_group(
+    size_type requested_size, const values_tuple &values,
+    index_sequence<J...>) {
+  group<K>().resize(requested_size,
+                    std::get<group_offset<K>::value + J>(values)...);
+}
+
+template <typename... G, typename... T, class Traits>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::push_back_groups(
+    const values_tuple &, group_index<groups_size>) {}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t K>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::push_back_groups(
+    const values_tuple &values, group_index<K>) {
+  push_back_group<K>(
+      values, make_index_sequence<group_type<K>::value_types_size>{});
+  try {
+    push_back_groups(values, group_index<K + 1>{});
+  } catch (...) {
+    group<K>().pop_back();
+    throw;
+  }
+}
+
+template <typename... G, typename... T, class Traits>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::
+    emplace_back_groups(group_index<groups_size>) {}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t K>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::
+    emplace_back_groups(group_index<K>) {
+  group<K>().emplace_back();
+  try {
+    emplace_back_groups(group_index<K + 1>{});
+  } catch (...) {
+    group<K>().pop_back();
+    throw;
+  }
+}
+
+template <typename... G, typename... T, class Traits>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::resize_groups(
+    size_type, const values_tuple &, group_index<groups_size>) {}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t K>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::resize_groups(
+    size_type requested_size, const values_tuple &values, group_index<K>) {
+  size_type old_size = group<K>().size();
+  resize_group<K>(requested_size, values,
+                  make_index_sequence<group_type<K>::value_types_size>{});
+  try {
+    resize_groups(requested_size, values, group_index<K + 1>{});
+  } catch (...) {
+    group<K>().resize(old_size);
+    throw;
+  }
+}
+
+template <typename... G, typename... T, class Traits>
+template <std::size_t... K>
+auto grouped_multivector<groups<G...>, types<T...>, Traits>::capacity(
+    index_sequence<K...>) const noexcept -> size_type {
+  const size_type capacities[] = {std::get<K>(_groups).capacity()...};
+  return *std::min_element(capacities, capacities + groups_size);
+}
+
+template <typename... G, typename... T, class Traits>
+template <class F>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::for_each_group(
+    F f) {
+  for_each_group(f, make_index_sequence<groups_size>{});
+}
+
+template <typename... G, typename... T, class Traits>
+template <class F, std::size_t... K>
+void grouped_multivector<groups<G...>, types<T...>, Traits>::for_each_group(
+    F &f, index_sequence<K...>) {
+  (void)swallow{(f(std::get<K>(_groups)), 0)...};
+}
+
+// a multivector whose columns are split in groups, each in its own allocation
+template <typename... G, class Traits>
+class multivector<groups<G...>, Traits>
+    : public grouped_multivector<
+          groups<G...>, typename grouped_value_types<Traits, G...>::type,
+          Traits> {
+public:
+  using grouped_multivector_type =
+      grouped_multivector<groups<G...>,
+                          typename grouped_value_types<Traits, G...>::type,
+                          Traits>;
+
+  using grouped_multivector_type::grouped_multivector;
+};
+
+} // namespace tl
+} // namespace nete
@@ -1,10 +1,15 @@
 #pragma once
 
+#include "parallel.h"
+#include "type_traits.h"
 #include "utility.h"
 
 #include <array>
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <new>
 #include <tuple>
 #include <type_traits>
 #include <vector>
@@ -15,6 +20,63 @@ namespace tl {
 struct enable_initialization_t {};
 struct disable_initialization_t {};
 
+// relocation strategies: allocate a new buffer and move the elements there, or
+// let the allocator grow the existing buffer (elements are relocated bytewise)
+struct move_relocation_t {};
+struct in_place_relocation_t {};
+
+// an allocator providing `reallocate`, which resizes a buffer with
+// `std::realloc`. It is valid only for trivially relocatable elements; for big
+// buffers glibc grows the mapping with `mremap`, without copying the pages.
+template <typename T> class malloc_allocator {
+public:
+  using value_type = T;
+  using pointer = T *;
+  using size_type = std::size_t;
+
+  template <typename U> struct rebind { using other = malloc_allocator<U>; };
+
+  malloc_allocator() noexcept = default;
+  template <typename U>
+  malloc_allocator(const malloc_allocator<U> &) noexcept {}
+
+  pointer allocate(size_type n) {
+    void *buffer = std::malloc(n * sizeof(T));
+    if (!buffer) {
+      throw std::bad_alloc{};
+    }
+    return static_cast<pointer>(buffer);
+  }
+
+  void deallocate(pointer buffer, size_type) noexcept { std::free(buffer); }
+
+  pointer reallocate(pointer buffer, size_type, size_type new_n) {
+    void *new_buffer = std::realloc(buffer, new_n * sizeof(T));
+    if (!new_buffer) {
+      throw std::bad_alloc{};
+    }
+    return static_cast<pointer>(new_buffer);
+  }
+
+  template <typename U> bool operator==(const malloc_allocator<U> &) const {
+    return true;
+  }
+  template <typename U> bool operator!=(const malloc_allocator<U> &) const {
+    return false;
+  }
+};
+
+// whether `Allocator` has `reallocate(pointer, old_n, new_n)`
+template <class Allocator, typename = void>
+struct allocator_has_reallocate : std::false_type {};
+
+template <class Allocator>
+struct allocator_has_reallocate<
+    Allocator,
+    void_t<decltype(std::declval<Allocator &>().reallocate(
+        std::declval<typename std::allocator_traits<Allocator>::pointer>(),
+        std::size_t{}, std::size_t{}))>> : std::true_type {};
+
 template <typename ForwardIt> void destroy(ForwardIt first, ForwardIt last) {
   using value_type = typename std::iterator_traits<ForwardIt>::value_type;
   for (; first != last; ++first) {
@@ -159,6 +221,43 @@ void multi_uninitialized_fill(std::tuple<T *...> arrays,
                                                values, initialization);
 }
 
+template <int I, typename... T> struct multi_uninitialized_emplace_impl {
+  template <typename... Args>
+  void operator()(std::tuple<T *...> arrays, std::size_t index,
+                  std::tuple<Args...> &args) {
+    constexpr std::size_t N = sizeof...(T), J = N - I - 1;
+    using value_type = nth_type_of<J, T...>;
+    using arg_type = nth_type_of<J, Args...>;
+
+    value_type *element = std::get<J>(arrays) + index;
+    ::new (static_cast<void *>(element))
+        value_type(std::forward<arg_type>(std::get<J>(args)));
+    try {
+      multi_uninitialized_emplace_impl<I - 1, T...>{}(arrays, index, args);
+    } catch (...) {
+      destroy(element, element + 1);
+      throw;
+    }
+  }
+};
+
+template <typename... T> struct multi_uninitialized_emplace_impl<-1, T...> {
+  template <typename... Args>
+  void operator()(std::tuple<T *...> arrays, std::size_t index,
+                  std::tuple<Args...> &args) {}
+};
+
+// constructs the element at `index` of each array from the corresponding
+// argument, forwarded as if by `std::forward<Args>`
+template <typename... T, typename... Args>
+void multi_uninitialized_emplace(std::tuple<T *...> arrays,
+                                 std::size_t index,
+                                 std::tuple<Args...> &args) {
+  static_assert(sizeof...(Args) == sizeof...(T), "");
+  constexpr std::size_t N = sizeof...(T);
+  multi_uninitialized_emplace_impl<N - 1, T...>{}(arrays, index, args);
+}
+
 template <int I, typename... T> struct multi_uninitialized_copy_impl {
   void operator()(std::tuple<const T *...> in_arrays, std::size_t size,
                   std::tuple<T *...> out_arrays,
@@ -174,6 +273,7 @@ template <int I, typename... T> struct multi_uninitialized_copy_impl {
                                                    initialization);
     } catch (...) {
       destroy(first_out, first_out + size);
+      throw;
     }
   }
 
@@ -215,7 +315,159 @@ void multi_uninitialized_copy(
     disable_initialization_t initialization) noexcept {
   constexpr std::size_t N = sizeof...(T);
   multi_uninitialized_copy_impl<N - 1, T...>{}(in_arrays, size, out_arrays,
-                                               initialization, initialization);
+                                               initialization);
+}
+
+template <int I, typename... T> struct multi_uninitialized_copy_n_impl {
+  template <typename... InputIterator>
+  void operator()(std::tuple<InputIterator...> firsts, std::size_t size,
+                  std::tuple<T *...> out_arrays) {
+    constexpr std::size_t N = sizeof...(T), J = N - I - 1;
+    using value_type = nth_type_of<J, T...>;
+
+    value_type *first_out = std::get<J>(out_arrays);
+    std::uninitialized_copy_n(std::get<J>(firsts), size, first_out);
+    try {
+      multi_uninitialized_copy_n_impl<I - 1, T...>{}(firsts, size,
+                                                     out_arrays);
+    } catch (...) {
+      destroy(first_out, first_out + size);
+      throw;
+    }
+  }
+};
+
+template <typename... T> struct multi_uninitialized_copy_n_impl<-1, T...> {
+  template <typename... InputIterator>
+  void operator()(std::tuple<InputIterator...> firsts, std::size_t size,
+                  std::tuple<T *...> out_arrays) {}
+};
+
+// copies `size` elements from each of the ranges starting at `firsts` to the
+// uninitialized arrays; for trivial types and pointer ranges this is a
+// `memmove` per array
+template <typename... InputIterator, typename... T>
+void multi_uninitialized_copy_n(std::tuple<InputIterator...> firsts,
+                                std::size_t size,
+                                std::tuple<T *...> out_arrays) {
+  static_assert(sizeof...(InputIterator) == sizeof...(T), "");
+  constexpr std::size_t N = sizeof...(T);
+  multi_uninitialized_copy_n_impl<N - 1, T...>{}(firsts, size, out_arrays);
+}
+
+template <int I, typename... T> struct multi_move_assign_impl {
+  void operator()(std::tuple<T *...> arrays, std::size_t from_index,
+                  std::size_t to_index) {
+    multi_move_assign_impl<I - 1, T...>{}(arrays, from_index, to_index);
+    std::get<I>(arrays)[to_index] = std::move(std::get<I>(arrays)[from_index]);
+  }
+};
+
+template <typename... T> struct multi_move_assign_impl<-1, T...> {
+  void operator()(std::tuple<T *...> arrays, std::size_t from_index,
+                  std::size_t to_index) {}
+};
+
+// move-assigns the elements at `from_index` to the ones at `to_index`
+template <typename... T>
+void multi_move_assign(std::tuple<T *...> arrays, std::size_t from_index,
+                       std::size_t to_index) {
+  constexpr std::size_t N = sizeof...(T);
+  multi_move_assign_impl<N - 1, T...>{}(arrays, from_index, to_index);
+}
+
+template <int I, typename... T> struct multi_move_impl {
+  void operator()(std::tuple<T *...> arrays, std::size_t first_index,
+                  std::size_t last_index, std::size_t result_index) {
+    multi_move_impl<I - 1, T...>{}(arrays, first_index, last_index,
+                                   result_index);
+    auto array = std::get<I>(arrays);
+    std::move(array + first_index, array + last_index, array + result_index);
+  }
+};
+
+template <typename... T> struct multi_move_impl<-1, T...> {
+  void operator()(std::tuple<T *...> arrays, std::size_t first_index,
+                  std::size_t last_index, std::size_t result_index) {}
+};
+
+// move-assigns the elements in [first_index, last_index) to the ones starting
+// at `result_index`, which must not be greater than `first_index`; trivial
+// columns are moved with `memmove`
+template <typename... T>
+void multi_move(std::tuple<T *...> arrays, std::size_t first_index,
+                std::size_t last_index, std::size_t result_index) {
+  constexpr std::size_t N = sizeof...(T);
+  multi_move_impl<N - 1, T...>{}(arrays, first_index, last_index,
+                                 result_index);
+}
+
+// reorders `array` so that `array[i]` becomes the former
+// `array[permutation[i]]`, using a scratch buffer. The gather and the move back
+// are split between `thread_count` threads, unless moves can throw.
+template <typename T, typename SizeType>
+void apply_permutation(T *array, std::size_t size, const SizeType *permutation,
+                       unsigned thread_count = 1) {
+  std::allocator<T> allocator;
+  T *scratch = allocator.allocate(size);
+  if (std::is_nothrow_move_constructible<T>::value &&
+      std::is_nothrow_move_assignable<T>::value) {
+    // chunks whose thread cannot be started run on this thread, so neither
+    // pass can throw
+    parallel_for_chunks(size, thread_count, [&](std::size_t, std::size_t first,
+                                                std::size_t last) {
+      for (std::size_t i = first; i < last; ++i) {
+        ::new (static_cast<void *>(scratch + i))
+            T(std::move(array[permutation[i]]));
+      }
+    });
+    parallel_for_chunks(size, thread_count, [&](std::size_t, std::size_t first,
+                                                std::size_t last) {
+      std::move(scratch + first, scratch + last, array + first);
+      destroy(scratch + first, scratch + last);
+    });
+  } else {
+    std::size_t i = 0;
+    try {
+      for (; i < size; ++i) {
+        ::new (static_cast<void *>(scratch + i))
+            T(std::move(array[permutation[i]]));
+      }
+      std::move(scratch, scratch + size, array);
+    } catch (...) {
+      destroy(scratch, scratch + i);
+      allocator.deallocate(scratch, size);
+      throw;
+    }
+    destroy(scratch, scratch + size);
+  }
+  allocator.deallocate(scratch, size);
+}
+
+template <int I, typename... T> struct multi_apply_permutation_impl {
+  template <typename SizeType>
+  void operator()(std::tuple<T *...> arrays, std::size_t size,
+                  const SizeType *permutation, unsigned thread_count) {
+    multi_apply_permutation_impl<I - 1, T...>{}(arrays, size, permutation,
+                                                thread_count);
+    apply_permutation(std::get<I>(arrays), size, permutation, thread_count);
+  }
+};
+
+template <typename... T> struct multi_apply_permutation_impl<-1, T...> {
+  template <typename SizeType>
+  void operator()(std::tuple<T *...> arrays, std::size_t size,
+                  const SizeType *permutation, unsigned thread_count) {}
+};
+
+// applies the same permutation to every array, one array at a time
+template <typename... T, typename SizeType>
+void multi_apply_permutation(std::tuple<T *...> arrays, std::size_t size,
+                             const SizeType *permutation,
+                             unsigned thread_count = 1) {
+  constexpr std::size_t N = sizeof...(T);
+  multi_apply_permutation_impl<N - 1, T...>{}(arrays, size, permutation,
+                                              thread_count);
 }
 
 template <typename InputIterator, typename ForwardIterator>
@@ -229,6 +481,22 @@ void uninitialized_move(InputIterator first, InputIterator last,
   }
 }
 
+// relocates the elements to the uninitialized `result`, ending the lifetime of
+// the old ones; trivially relocatable elements are copied bytewise at once
+template <typename T>
+void uninitialized_relocate(T *first, T *last, T *result, std::true_type) {
+  // the arrays of an empty container may be null
+  if (first != last) {
+    std::memcpy(static_cast<void *>(result), static_cast<const void *>(first),
+                sizeof(T) * (last - first));
+  }
+}
+
+template <typename T>
+void uninitialized_relocate(T *first, T *last, T *result, std::false_type) {
+  uninitialized_move(first, last, result);
+}
+
 template <int I, typename... T> struct multi_uninitialized_move_impl {
   void operator()(std::tuple<T *...> in_arrays, std::size_t size,
                   std::tuple<T *...> out_arrays) {
@@ -237,7 +505,8 @@ template <int I, typename... T> struct multi_uninitialized_move_impl {
     multi_uninitialized_move_impl<I - 1, T...>{}(in_arrays, size, out_arrays);
     value_type *first_in = std::get<I>(in_arrays);
     value_type *first_out = std::get<I>(out_arrays);
-    uninitialized_move(first_in, first_in + size, first_out);
+    uninitialized_relocate(first_in, first_in + size, first_out,
+                           is_trivially_relocatable<value_type>{});
   }
 };
 
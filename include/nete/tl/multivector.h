@@ -2,11 +2,17 @@
 
 #include "fast_vector.h"
 #include "memory.h"
+#include "radix_sort.h"
 #include "type_traits.h"
 #include "utility.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <thread>
 #include <tuple>
 #include <type_traits>
 #include <vector>
@@ -14,40 +20,103 @@
 namespace nete {
 namespace tl {
 
-template <int I, std::size_t N, typename... T>
-struct calculate_multivector_offsets_impl {
-  void operator()(std::array<std::size_t, N> &offsets, std::size_t size) {
-    using prev_value_type = nth_type_of<I - 1, T...>;
-    using value_type = nth_type_of<I, T...>;
-    calculate_multivector_offsets_impl<I - 1, N, T...>{}(offsets, size);
-    std::size_t prev_offset = offsets[I - 1];
-    std::size_t offset = next_multiple_of_gte(
-        prev_offset + sizeof(prev_value_type) * size, alignof(value_type));
-    offsets[I] = offset;
+// the position of the column `I` in the storage. The columns are stored by
+// descending alignment, so no padding is needed between them, and columns of
+// equal alignment keep their order.
+template <std::size_t I, typename Indices, typename... T>
+struct multivector_storage_position;
+
+template <std::size_t I, std::size_t... J, typename... T>
+struct multivector_storage_position<I, index_sequence<J...>, T...>
+    : std::integral_constant<
+          std::size_t,
+          constexpr_sum(
+              (alignof(nth_type_of<J, T...>) > alignof(nth_type_of<I, T...>) ||
+               (alignof(nth_type_of<J, T...>) ==
+                    alignof(nth_type_of<I, T...>) &&
+                J < I))...)> {};
+
+template <typename Indices, typename... T> struct multivector_layout_impl;
+
+template <std::size_t... I, typename... T>
+struct multivector_layout_impl<index_sequence<I...>, T...> {
+  static constexpr std::size_t positions[] = {
+      multivector_storage_position<I, index_sequence<I...>, T...>::value...};
+  static constexpr std::size_t sizes[] = {sizeof(T)...};
+  static constexpr std::size_t alignments[] = {alignof(T)...};
+
+  // the column stored at `position`
+  static constexpr std::size_t column_at(std::size_t position,
+                                         std::size_t column = 0) {
+    return positions[column] == position ? column
+                                         : column_at(position, column + 1);
+  }
+
+  static constexpr std::size_t aligned_offset(std::size_t offset,
+                                              std::size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+  }
+
+  // the offset of the column stored at `position`, each column being aligned
+  // to its type and to `column_alignment`
+  static constexpr std::size_t offset_at(std::size_t position,
+                                         std::size_t size,
+                                         std::size_t column_alignment) {
+    return position == 0
+               ? 0
+               : aligned_offset(
+                     offset_at(position - 1, size, column_alignment) +
+                         sizes[column_at(position - 1)] * size,
+                     alignments[column_at(position)] > column_alignment
+                         ? alignments[column_at(position)]
+                         : column_alignment);
+  }
+
+  // the offsets of the columns of `size` elements, indexed like the columns
+  static std::array<std::size_t, sizeof...(T)>
+  offsets(std::size_t size, std::size_t column_alignment) {
+    return {{offset_at(positions[I], size, column_alignment)...}};
   }
-};
 
-template <std::size_t N, typename... T>
-struct calculate_multivector_offsets_impl<0, N, T...> {
-  void operator()(std::array<std::size_t, N> &offsets, std::size_t size) {
-    std::size_t offset = 0;
-    offsets[0] = offset;
+  // the size of the columns of `size` elements, without the storage padding
+  static constexpr std::size_t storage_size(std::size_t size,
+                                            std::size_t column_alignment) {
+    return offset_at(sizeof...(T) - 1, size, column_alignment) +
+           sizes[column_at(sizeof...(T) - 1)] * size;
   }
 };
 
+template <std::size_t... I, typename... T>
+constexpr std::size_t
+    multivector_layout_impl<index_sequence<I...>, T...>::positions[];
+template <std::size_t... I, typename... T>
+constexpr std::size_t
+    multivector_layout_impl<index_sequence<I...>, T...>::sizes[];
+template <std::size_t... I, typename... T>
+constexpr std::size_t
+    multivector_layout_impl<index_sequence<I...>, T...>::alignments[];
+
+// the compile-time layout of the columns `T...` in a multivector's storage
+template <typename... T>
+using multivector_layout =
+    multivector_layout_impl<make_index_sequence<sizeof...(T)>, T...>;
+
+// offsets of the columns from the beginning of the storage, indexed like the
+// columns, though the columns are stored in the order of `multivector_layout`;
+// each column is aligned to its type and to `column_alignment`
 template <typename... T>
 std::array<std::size_t, sizeof...(T)>
-calculate_multivector_offsets(std::size_t size) {
-  constexpr std::size_t N = sizeof...(T);
-  std::array<std::size_t, N> offsets;
-  calculate_multivector_offsets_impl<N - 1, N, T...>{}(offsets, size);
-  return offsets;
+calculate_multivector_offsets(std::size_t size,
+                              std::size_t column_alignment = 1) {
+  return multivector_layout<T...>::offsets(size, column_alignment);
 }
 
 template <typename... T>
 std::size_t calculate_multivector_storage_size(
     const std::array<std::size_t, sizeof...(T)> &offsets, std::size_t size) {
-  return offsets.back() + sizeof(last_type_of<T...>) * size;
+  using layout = multivector_layout<T...>;
+  std::size_t last = layout::column_at(sizeof...(T) - 1);
+  return offsets[last] + layout::sizes[last] * size;
 }
 
 template <int I, typename... T> struct calculate_multivector_pointers_impl {
@@ -78,12 +147,71 @@ std::tuple<T *...> calculate_multivector_pointers(
   return arrays;
 }
 
+// moves the columns of trivially relocatable types inside `storage` from the
+// layout described by `from` to the one described by `to`. Both layouts have
+// to keep the columns in the same order.
+template <typename... T>
+void relocate_multivector_columns(
+    byte_type *storage, const std::array<std::size_t, sizeof...(T)> &from,
+    const std::array<std::size_t, sizeof...(T)> &to, std::size_t size) {
+  constexpr std::size_t N = sizeof...(T);
+  const std::size_t sizes[] = {sizeof(T)...};
+  std::array<std::size_t, N> order;
+  for (std::size_t i = 0; i < N; ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&from](std::size_t a, std::size_t b) {
+    return from[a] < from[b];
+  });
+  // columns moving backwards go first, from the lowest one, and columns moving
+  // forwards go next, from the highest one, so no column is overwritten before
+  // it is moved
+  for (std::size_t i = 0; i < N; ++i) {
+    std::size_t j = order[i];
+    if (to[j] < from[j]) {
+      std::memmove(storage + to[j], storage + from[j], sizes[j] * size);
+    }
+  }
+  for (std::size_t i = N; i-- > 0;) {
+    std::size_t j = order[i];
+    if (to[j] > from[j]) {
+      std::memmove(storage + to[j], storage + from[j], sizes[j] * size);
+    }
+  }
+}
+
 struct multivector_traits {
   using allocator_type = std::allocator<char>;
   using size_type = size_t;
+  using growth_policy = geometric_growth<>;
   static constexpr bool disable_initialization = false;
+  // the minimal alignment of the beginning of each column, e.g. 64 to put the
+  // columns on separate cache lines and make them suitable for aligned loads
+  static constexpr std::size_t column_alignment = 1;
+};
+
+// traits may omit `growth_policy`, in which case the default one is used
+template <class Traits, typename = void> struct multivector_growth_policy {
+  using type = geometric_growth<>;
 };
 
+template <class Traits>
+struct multivector_growth_policy<Traits,
+                                 void_t<typename Traits::growth_policy>> {
+  using type = typename Traits::growth_policy;
+};
+
+// traits may omit `column_alignment`, in which case columns are aligned only
+// to their types
+template <class Traits, typename = void>
+struct multivector_column_alignment
+    : std::integral_constant<std::size_t, 1> {};
+
+template <class Traits>
+struct multivector_column_alignment<Traits,
+                                    void_t<decltype(Traits::column_alignment)>>
+    : std::integral_constant<std::size_t, Traits::column_alignment> {};
+
 template <class Container>
 class multivector_iterator
     : public std::iterator<std::random_access_iterator_tag,
@@ -166,6 +294,234 @@ private:
   size_type _index;
 };
 
+// a tuple of references to the elements of a row. Assigning to it assigns to
+// the elements, and swapping two of them swaps the rows, so it can be used by
+// mutating algorithms like `std::sort` although it's not a real reference.
+template <typename... T>
+class multivector_zip_reference : public std::tuple<T &...> {
+public:
+  using base = std::tuple<T &...>;
+  using value_type = std::tuple<T...>;
+  using indices = make_index_sequence<sizeof...(T)>;
+
+  multivector_zip_reference(T &... elements) : base(elements...) {}
+  multivector_zip_reference(const multivector_zip_reference &) = default;
+
+  multivector_zip_reference &operator=(const multivector_zip_reference &rhs) {
+    base::operator=(rhs);
+    return *this;
+  }
+  multivector_zip_reference &operator=(multivector_zip_reference &&rhs) {
+    move_assign(rhs, indices{});
+    return *this;
+  }
+  multivector_zip_reference &operator=(const value_type &rhs) {
+    base::operator=(rhs);
+    return *this;
+  }
+  multivector_zip_reference &operator=(value_type &&rhs) {
+    base::operator=(std::move(rhs));
+    return *this;
+  }
+
+  friend inline void swap(multivector_zip_reference lhs,
+                          multivector_zip_reference rhs) {
+    lhs.swap_elements(rhs, indices{});
+  }
+
+private:
+  template <std::size_t... I>
+  void move_assign(multivector_zip_reference &rhs, index_sequence<I...>) {
+    (void)swallow{
+        (std::get<I>(*this) = std::move(std::get<I>(rhs)), 0)...};
+  }
+
+  template <std::size_t... I>
+  void swap_elements(multivector_zip_reference &rhs, index_sequence<I...>) {
+    using std::swap;
+    (void)swallow{(swap(std::get<I>(*this), std::get<I>(rhs)), 0)...};
+  }
+};
+
+// an iterator over the rows of chosen columns, dereferencing to a
+// `multivector_zip_reference` to the row's elements; it's a tuple of column
+// pointers that are advanced together
+template <typename... T>
+class multivector_zip_iterator
+    : public std::iterator<std::random_access_iterator_tag, std::tuple<T...>,
+                           std::ptrdiff_t, void,
+                           multivector_zip_reference<T...>> {
+public:
+  using base =
+      std::iterator<std::random_access_iterator_tag, std::tuple<T...>,
+                    std::ptrdiff_t, void, multivector_zip_reference<T...>>;
+  using difference_type = typename base::difference_type;
+  using reference = typename base::reference;
+  using pointer_tuple = std::tuple<T *...>;
+  using indices = make_index_sequence<sizeof...(T)>;
+
+  static_assert(sizeof...(T) > 0, "");
+
+  multivector_zip_iterator(pointer_tuple pointers) : _pointers(pointers) {}
+
+  inline reference operator*() const { return dereference(0, indices{}); }
+  inline reference operator[](difference_type n) const {
+    return dereference(n, indices{});
+  }
+
+  const pointer_tuple &pointers() const { return _pointers; }
+
+  inline multivector_zip_iterator &operator++() {
+    advance(1, indices{});
+    return *this;
+  }
+  inline multivector_zip_iterator &operator--() {
+    advance(-1, indices{});
+    return *this;
+  }
+  inline multivector_zip_iterator operator++(int) {
+    multivector_zip_iterator tmp(*this);
+    advance(1, indices{});
+    return tmp;
+  }
+  inline multivector_zip_iterator operator--(int) {
+    multivector_zip_iterator tmp(*this);
+    advance(-1, indices{});
+    return tmp;
+  }
+  inline difference_type operator-(const multivector_zip_iterator &rhs) const {
+    return std::get<0>(_pointers) - std::get<0>(rhs._pointers);
+  }
+  inline multivector_zip_iterator operator+(difference_type rhs) const {
+    multivector_zip_iterator tmp(*this);
+    tmp.advance(rhs, indices{});
+    return tmp;
+  }
+  inline multivector_zip_iterator operator-(difference_type rhs) const {
+    multivector_zip_iterator tmp(*this);
+    tmp.advance(-rhs, indices{});
+    return tmp;
+  }
+
+  friend inline multivector_zip_iterator
+  operator+(difference_type lhs, const multivector_zip_iterator &rhs) {
+    return rhs + lhs;
+  }
+
+  inline multivector_zip_iterator &operator+=(difference_type rhs) {
+    advance(rhs, indices{});
+    return *this;
+  }
+  inline multivector_zip_iterator &operator-=(difference_type rhs) {
+    advance(-rhs, indices{});
+    return *this;
+  }
+
+  inline bool operator==(const multivector_zip_iterator &rhs) const {
+    return std::get<0>(_pointers) == std::get<0>(rhs._pointers);
+  }
+  inline bool operator!=(const multivector_zip_iterator &rhs) const {
+    return std::get<0>(_pointers) != std::get<0>(rhs._pointers);
+  }
+  inline bool operator>(const multivector_zip_iterator &rhs) const {
+    return std::get<0>(_pointers) > std::get<0>(rhs._pointers);
+  }
+  inline bool operator<(const multivector_zip_iterator &rhs) const {
+    return std::get<0>(_pointers) < std::get<0>(rhs._pointers);
+  }
+  inline bool operator>=(const multivector_zip_iterator &rhs) const {
+    return std::get<0>(_pointers) >= std::get<0>(rhs._pointers);
+  }
+  inline bool operator<=(const multivector_zip_iterator &rhs) const {
+    return std::get<0>(_pointers) <= std::get<0>(rhs._pointers);
+  }
+
+private:
+  template <std::size_t... I>
+  inline reference dereference(difference_type n, index_sequence<I...>) const {
+    return reference{std::get<I>(_pointers)[n]...};
+  }
+
+  template <std::size_t... I>
+  inline void advance(difference_type n, index_sequence<I...>) {
+    (void)swallow{(std::get<I>(_pointers) += n, 0)...};
+  }
+
+  pointer_tuple _pointers;
+};
+
+// a range of `multivector_zip_iterator`s, usable in range-based for loops
+template <typename... T> class multivector_zip_range {
+public:
+  using iterator = multivector_zip_iterator<T...>;
+  using size_type = std::size_t;
+
+  multivector_zip_range(std::tuple<T *...> pointers, size_type size)
+      : _begin(pointers), _end(_begin + size) {}
+
+  iterator begin() const noexcept { return _begin; }
+  iterator end() const noexcept { return _end; }
+  size_type size() const noexcept { return _end - _begin; }
+  bool empty() const noexcept { return _begin == _end; }
+
+private:
+  iterator _begin;
+  iterator _end;
+};
+
+// a non-owning view of some columns of a multivector. The column pointers are
+// hoisted out of the multivector, and as they never alias, `for_each` passes
+// them to the loop as restrict-qualified pointers, which enables
+// auto-vectorization. The view is invalidated by reallocation.
+template <typename... T> class multivector_view {
+public:
+  template <std::size_t I> using value_type = nth_type_of<I, T...>;
+  template <std::size_t I> using reference = value_type<I> &;
+  template <std::size_t I> using pointer = value_type<I> *;
+  using size_type = std::size_t;
+  using iterator = multivector_zip_iterator<T...>;
+  using pointer_tuple = std::tuple<T *...>;
+  using indices = make_index_sequence<sizeof...(T)>;
+
+  multivector_view(pointer_tuple pointers, size_type size)
+      : _pointers(pointers), _size(size) {}
+
+  template <std::size_t I> reference<I> at(size_type i) const {
+    assert(i < size());
+    return std::get<I>(_pointers)[i];
+  }
+  template <std::size_t I> pointer<I> data() const noexcept {
+    return std::get<I>(_pointers);
+  }
+
+  iterator begin() const noexcept { return iterator{_pointers}; }
+  iterator end() const noexcept { return begin() + _size; }
+
+  bool empty() const noexcept { return _size == 0; }
+  size_type size() const noexcept { return _size; }
+
+  // calls `f` with references to the elements of each row
+  template <class F> void for_each(F f) const {
+    for_each_impl(f, indices{});
+  }
+
+private:
+  template <class F, std::size_t... I>
+  void for_each_impl(F &f, index_sequence<I...>) const {
+    for_each_row(f, _size, std::get<I>(_pointers)...);
+  }
+
+  template <class F>
+  static void for_each_row(F &f, size_type size, T *NETE_RESTRICT... columns) {
+    for (size_type i = 0; i < size; ++i) {
+      f(columns[i]...);
+    }
+  }
+
+  pointer_tuple _pointers;
+  size_type _size;
+};
+
 template <typename Types, class Traits = multivector_traits>
 struct multivector_base;
 
@@ -177,22 +533,97 @@ struct multivector_base<types<T...>, Traits> {
   using offset_array = std::array<std::size_t, sizeof...(T)>;
   using address_tuple = std::tuple<T *...>;
 
+  static constexpr std::size_t column_alignment =
+      multivector_column_alignment<Traits>::value;
+  static constexpr std::size_t storage_alignment =
+      max_alignof<T...>::value > column_alignment ? max_alignof<T...>::value
+                                                  : column_alignment;
+  // the allocator is trusted to align the storage like `operator new` does,
+  // stricter alignment is achieved by over-allocating
+  static constexpr std::size_t storage_padding =
+      storage_alignment > alignof(std::max_align_t) ? storage_alignment - 1
+                                                      : 0;
+
+  static_assert((column_alignment & (column_alignment - 1)) == 0,
+                "Column alignment must be a power of two!");
+
   multivector_base(const allocator_type &alloc, size_type capacity,
                    size_type size)
       : _storage(alloc), _capacity(capacity), _size(size) {
-    offset_array offsets = calculate_multivector_offsets<T...>(_capacity);
-    std::size_t storage_size =
-        calculate_multivector_storage_size<T...>(offsets, _capacity);
-    _storage.resize(storage_size);
-    _arrays = calculate_multivector_pointers<T...>(offsets, _storage.data());
+    offset_array offsets =
+        calculate_multivector_offsets<T...>(_capacity, column_alignment);
+    _storage.resize(storage_size(_capacity));
+    _arrays = calculate_multivector_pointers<T...>(offsets, storage_begin());
   }
 
-  multivector_base(multivector_base &&x) = default;
-  multivector_base &operator=(multivector_base &&x) = default;
+  multivector_base(multivector_base &&x)
+      : _storage(std::move(x._storage)), _capacity(x._capacity),
+        _size(x._size), _arrays(x._arrays) {
+    x._capacity = 0;
+    x._size = 0;
+  }
+
+  multivector_base &operator=(multivector_base &&x) {
+    std::swap(_storage, x._storage);
+    std::swap(_capacity, x._capacity);
+    std::swap(_size, x._size);
+    std::swap(_arrays, x._arrays);
+    return *this;
+  }
 
   multivector_base(const multivector_base &x) = delete;
   multivector_base &operator=(const multivector_base &x) = delete;
 
+  static constexpr std::size_t storage_size(size_type capacity) {
+    return capacity ? multivector_layout<T...>::storage_size(
+                          capacity, column_alignment) +
+                          storage_padding
+                    : 0;
+  }
+
+  byte_type *storage_begin() {
+    return align_up(_storage.data(), storage_alignment);
+  }
+
+  // changes the capacity without moving the rows out of the storage, which
+  // is valid only for trivially relocatable types
+  void reallocate(size_type new_capacity) {
+    offset_array offsets =
+        calculate_multivector_offsets<T...>(_capacity, column_alignment);
+    offset_array new_offsets =
+        calculate_multivector_offsets<T...>(new_capacity, column_alignment);
+    // the reallocated storage may be aligned differently than the old one
+    std::size_t padding = storage_begin() - _storage.data();
+    if (new_capacity > _capacity) {
+      _storage.resize(storage_size(new_capacity));
+      std::size_t new_padding = storage_begin() - _storage.data();
+      relocate_multivector_columns<T...>(_storage.data(),
+                                         shifted(offsets, padding),
+                                         shifted(new_offsets, new_padding),
+                                         _size);
+    } else {
+      relocate_multivector_columns<T...>(_storage.data(),
+                                         shifted(offsets, padding),
+                                         shifted(new_offsets, padding), _size);
+      _storage.resize(storage_size(new_capacity));
+      _storage.shrink_to_fit();
+      std::size_t new_padding = storage_begin() - _storage.data();
+      if (new_capacity && new_padding != padding) {
+        std::memmove(_storage.data() + new_padding, _storage.data() + padding,
+                     _storage.size() - storage_padding);
+      }
+    }
+    _capacity = new_capacity;
+    _arrays = calculate_multivector_pointers<T...>(new_offsets, storage_begin());
+  }
+
+  static offset_array shifted(offset_array offsets, std::size_t shift) {
+    for (std::size_t &offset : offsets) {
+      offset += shift;
+    }
+    return offsets;
+  }
+
   storage_type _storage;
   size_type _capacity;
   size_type _size;
@@ -206,26 +637,42 @@ public:
   template <std::size_t I> using value_type = nth_type_of<I, T...>;
   using value_types = types<T...>;
   using allocator_type = typename Traits::allocator_type;
+  using growth_policy = typename multivector_growth_policy<Traits>::type;
   template <std::size_t I> using reference = value_type<I> &;
   template <std::size_t I> using const_reference = const value_type<I> &;
   using size_type = typename Traits::size_type;
   using iterator = multivector_iterator<multivector>;
   using reverse_iterator = std::reverse_iterator<iterator>;
+  template <std::size_t... I>
+  using zip_range = multivector_zip_range<value_type<I>...>;
+  template <std::size_t... I>
+  using const_zip_range = multivector_zip_range<const value_type<I>...>;
+  template <std::size_t... I>
+  using view_type = multivector_view<value_type<I>...>;
+  template <std::size_t... I>
+  using const_view_type = multivector_view<const value_type<I>...>;
   template <std::size_t I> using pointer = value_type<I> *;
   template <std::size_t I> using const_pointer = const value_type<I> *;
   using initialization_t =
       typename std::conditional<Traits::disable_initialization,
                                 disable_initialization_t,
                                 enable_initialization_t>::type;
+  using relocation_t = typename std::conditional<
+      are_trivially_relocatable<T...>::value &&
+          allocator_has_reallocate<allocator_type>::value,
+      in_place_relocation_t, move_relocation_t>::type;
 
   using multivector_type = multivector<types<T...>, Traits>;
   using multivector_base_type = multivector_base<value_types, Traits>;
+  using address_tuple = typename multivector_base_type::address_tuple;
 
   static constexpr std::size_t value_types_size = value_types::size;
   static constexpr std::size_t sizeof_value_types =
       sizeof_tuple_head<value_types_size, std::tuple<T...>>::value;
   static constexpr initialization_t initialization_strategy =
       initialization_t{};
+  static constexpr relocation_t relocation_strategy = relocation_t{};
+  static constexpr size_type npos = static_cast<size_type>(-1);
 
   static_assert(value_types_size > 0, "");
   static_assert(!Traits::disable_initialization || are_trivial<T...>::value,
@@ -236,9 +683,10 @@ public:
   multivector(size_type size, const allocator_type &alloc = allocator_type{});
   multivector(const multivector &x);
   multivector(multivector &&x) = default;
+  ~multivector();
 
   multivector &operator=(const multivector &x);
-  multivector &operator=(multivector &&x) = default;
+  multivector &operator=(multivector &&x);
 
   allocator_type get_allocator() const noexcept;
 
@@ -251,26 +699,72 @@ public:
   template <std::size_t I> pointer<I> data() noexcept;
   template <std::size_t I> const_pointer<I> data() const noexcept;
   const byte_type *storage() const noexcept;
+  static constexpr std::size_t storage_size(size_type capacity);
 
   iterator begin() noexcept;
   iterator end() noexcept;
   reverse_iterator rbegin() noexcept;
   reverse_iterator rend() noexcept;
+  template <std::size_t... I> zip_range<I...> zip() noexcept;
+  template <std::size_t... I> const_zip_range<I...> zip() const noexcept;
+  multivector_zip_range<T...> zip() noexcept;
+  multivector_zip_range<const T...> zip() const noexcept;
+  template <std::size_t... I> view_type<I...> view() noexcept;
+  template <std::size_t... I> const_view_type<I...> view() const noexcept;
 
   bool empty() const noexcept;
   size_type size() const noexcept;
   void reserve(size_type requested_capacity);
   size_type capacity() const noexcept;
+  void shrink_to_fit();
 
   void clear() noexcept;
   void push_back(const T &... values);
+  void push_back(T &&... values);
   void emplace_back();
+  template <class... Args> void emplace_back(Args &&... args);
   void pop_back();
   void resize(size_type requested_size);
   void resize(size_type requested_size, const T &... values);
+  void append(size_type count, const T *... sources);
+  template <class... InputIterator>
+  void append(size_type count, InputIterator... firsts);
   void swap(iterator first, iterator second);
+  size_type erase_unordered(iterator position);
+  template <class BidirectionalIterator>
+  void erase_unordered(BidirectionalIterator first, BidirectionalIterator last);
+  template <class BidirectionalIterator, class MoveObserver>
+  void erase_unordered(BidirectionalIterator first, BidirectionalIterator last,
+                       MoveObserver on_move);
+  template <std::size_t... I, class Predicate>
+  size_type remove_if(Predicate pred);
+  template <std::size_t... I, class Predicate, class RemapObserver>
+  size_type remove_if(Predicate pred, RemapObserver on_remap);
+  template <std::size_t I> void sort_by();
+  template <std::size_t I, class Compare> void sort_by(Compare comp);
+  template <std::size_t I>
+  void parallel_sort_by(
+      unsigned thread_count = std::thread::hardware_concurrency());
 
 private:
+  template <std::size_t I> void sort_by_impl(std::true_type radix_sortable);
+  template <std::size_t I> void sort_by_impl(std::false_type radix_sortable);
+  template <class Predicate, std::size_t... I>
+  bool test_row(Predicate &pred, size_type index, index_sequence<I...>);
+  template <std::size_t... I>
+  address_tuple arrays_at(size_type index, index_sequence<I...>) noexcept;
+  template <class... Args, std::size_t... I>
+  static std::tuple<T...> make_row(std::tuple<Args...> &args,
+                                   index_sequence<I...>);
+
+  void reallocate(size_type new_capacity, move_relocation_t);
+  void reallocate(size_type new_capacity, in_place_relocation_t);
+  template <class... Args>
+  void grow_and_emplace_back(std::tuple<Args...> &args, move_relocation_t);
+  template <class... Args>
+  void grow_and_emplace_back(std::tuple<Args...> &args,
+                             in_place_relocation_t);
+
   multivector_base_type _base;
 };
 
@@ -303,6 +797,11 @@ multivector<types<T...>, Traits>::multivector(const multivector &x)
                            initialization_strategy);
 }
 
+template <typename... T, class Traits>
+multivector<types<T...>, Traits>::~multivector() {
+  multi_destroy(_base._arrays, 0, size(), initialization_strategy);
+}
+
 template <typename... T, class Traits>
 auto multivector<types<T...>, Traits>::operator=(const multivector &x)
     -> multivector & {
@@ -311,6 +810,14 @@ auto multivector<types<T...>, Traits>::operator=(const multivector &x)
   return *this;
 }
 
+template <typename... T, class Traits>
+auto multivector<types<T...>, Traits>::operator=(multivector &&x)
+    -> multivector & {
+  clear();
+  _base = std::move(x._base);
+  return *this;
+}
+
 template <typename... T, class Traits>
 auto multivector<types<T...>, Traits>::get_allocator() const noexcept
     -> allocator_type {
@@ -342,7 +849,7 @@ template <typename... T, class Traits>
 template <std::size_t I>
 auto multivector<types<T...>, Traits>::get(iterator it) const
     -> const_reference<I> {
-  return const_cast<multivector *>(this)->get(it);
+  return const_cast<multivector *>(this)->template get<I>(it);
 }
 
 template <typename... T, class Traits>
@@ -356,7 +863,7 @@ template <typename... T, class Traits>
 template <std::size_t I>
 auto multivector<types<T...>, Traits>::get(reverse_iterator rit) const
     -> const_reference<I> {
-  return const_cast<multivector *>(this)->get(rit);
+  return const_cast<multivector *>(this)->template get<I>(rit);
 }
 
 template <typename... T, class Traits>
@@ -369,12 +876,20 @@ template <typename... T, class Traits>
 template <std::size_t I>
 auto multivector<types<T...>, Traits>::data() const noexcept
     -> const_pointer<I> {
-  return const_cast<multivector *>(this)->data();
+  return std::get<I>(_base._arrays);
 }
 
 template <typename... T, class Traits>
 const byte_type *multivector<types<T...>, Traits>::storage() const noexcept {
-  return _base._storage.data();
+  return const_cast<multivector_base_type &>(_base).storage_begin();
+}
+
+// the number of bytes allocated for `capacity` rows, e.g. for checking memory
+// budgets at compile time
+template <typename... T, class Traits>
+constexpr std::size_t
+multivector<types<T...>, Traits>::storage_size(size_type capacity) {
+  return multivector_base_type::storage_size(capacity);
 }
 
 template <typename... T, class Traits>
@@ -397,9 +912,50 @@ auto multivector<types<T...>, Traits>::rend() noexcept -> reverse_iterator {
   return std::reverse_iterator<iterator>{begin()};
 }
 
+template <typename... T, class Traits>
+template <std::size_t... I>
+auto multivector<types<T...>, Traits>::zip() noexcept -> zip_range<I...> {
+  return zip_range<I...>{std::make_tuple(data<I>()...), size()};
+}
+
+template <typename... T, class Traits>
+template <std::size_t... I>
+auto multivector<types<T...>, Traits>::zip() const noexcept
+    -> const_zip_range<I...> {
+  return const_zip_range<I...>{std::make_tuple(data<I>()...), size()};
+}
+
+template <typename... T, class Traits>
+auto multivector<types<T...>, Traits>::zip() noexcept
+    -> multivector_zip_range<T...> {
+  return multivector_zip_range<T...>{_base._arrays, size()};
+}
+
+template <typename... T, class Traits>
+auto multivector<types<T...>, Traits>::zip() const noexcept
+    -> multivector_zip_range<const T...> {
+  return multivector_zip_range<const T...>{_base._arrays, size()};
+}
+
+template <typename... T, class Traits>
+template <std::size_t... I>
+auto multivector<types<T...>, Traits>::view() noexcept -> view_type<I...> {
+  // the columns of a view are accessed through restrict-qualified pointers
+  static_assert(constexpr_distinct(I...),
+                "A mutable view cannot contain a column more than once!");
+  return view_type<I...>{std::make_tuple(data<I>()...), size()};
+}
+
+template <typename... T, class Traits>
+template <std::size_t... I>
+auto multivector<types<T...>, Traits>::view() const noexcept
+    -> const_view_type<I...> {
+  return const_view_type<I...>{std::make_tuple(data<I>()...), size()};
+}
+
 template <typename... T, class Traits>
 bool multivector<types<T...>, Traits>::empty() const noexcept {
-  return _base._storage.empty();
+  return size() == 0;
 }
 
 template <typename... T, class Traits>
@@ -412,10 +968,7 @@ void multivector<types<T...>, Traits>::reserve(size_type requested_capacity) {
   if (requested_capacity <= capacity()) {
     return;
   }
-  multivector_base_type new_base{_base._storage.get_allocator(),
-                                 requested_capacity, size()};
-  multi_uninitialized_move(_base._arrays, _base._capacity, new_base._arrays);
-  std::swap(_base, new_base);
+  reallocate(requested_capacity, relocation_strategy);
 }
 
 template <typename... T, class Traits>
@@ -423,6 +976,14 @@ auto multivector<types<T...>, Traits>::capacity() const noexcept -> size_type {
   return _base._capacity;
 }
 
+template <typename... T, class Traits>
+void multivector<types<T...>, Traits>::shrink_to_fit() {
+  if (size() == capacity()) {
+    return;
+  }
+  reallocate(size(), relocation_strategy);
+}
+
 template <typename... T, class Traits>
 void multivector<types<T...>, Traits>::clear() noexcept {
   resize(0);
@@ -430,12 +991,39 @@ void multivector<types<T...>, Traits>::clear() noexcept {
 
 template <typename... T, class Traits>
 void multivector<types<T...>, Traits>::push_back(const T &... values) {
-  resize(size() + 1, values...);
+  emplace_back(values...);
+}
+
+template <typename... T, class Traits>
+void multivector<types<T...>, Traits>::push_back(T &&... values) {
+  emplace_back(std::move(values)...);
 }
 
 template <typename... T, class Traits>
 void multivector<types<T...>, Traits>::emplace_back() {
-  resize(size() + 1);
+  if (size() == capacity()) {
+    reserve(growth_policy::next_capacity(capacity(), size() + 1));
+  }
+  multi_uninitialized_construct(_base._arrays, size(), size() + 1,
+                                initialization_strategy);
+  ++_base._size;
+}
+
+// appends a row, constructing the element of each column from the
+// corresponding argument; the arguments may refer to the elements of this
+// multivector
+template <typename... T, class Traits>
+template <class... Args>
+void multivector<types<T...>, Traits>::emplace_back(Args &&... args) {
+  static_assert(sizeof...(Args) == value_types_size,
+                "An argument is needed for each column!");
+  std::tuple<Args &&...> args_tuple{std::forward<Args>(args)...};
+  if (size() < capacity()) {
+    multi_uninitialized_emplace(_base._arrays, size(), args_tuple);
+  } else {
+    grow_and_emplace_back(args_tuple, relocation_strategy);
+  }
+  ++_base._size;
 }
 
 template <typename... T, class Traits>
@@ -465,12 +1053,79 @@ void multivector<types<T...>, Traits>::resize(size_type requested_size,
     multi_uninitialized_fill(_base._arrays, size(), requested_size,
                              values_tuple, initialization_strategy);
   } else {
-    multi_destroy(_base._arrays, size(), requested_size,
+    multi_destroy(_base._arrays, requested_size, size(),
                   initialization_strategy);
   }
   _base._size = requested_size;
 }
 
+// appends `count` rows, copying the elements of each column from its own
+// array, which must not be a column of this multivector. The storage grows at
+// most once, and each column is copied at once, with a `memmove` for trivial
+// types.
+template <typename... T, class Traits>
+void multivector<types<T...>, Traits>::append(size_type count,
+                                              const T *... sources) {
+  append<const T *...>(count, sources...);
+}
+
+// as above, copying the elements of each column from the range starting at
+// the corresponding iterator
+template <typename... T, class Traits>
+template <class... InputIterator>
+void multivector<types<T...>, Traits>::append(size_type count,
+                                              InputIterator... firsts) {
+  static_assert(sizeof...(InputIterator) == value_types_size,
+                "An iterator is needed for each column!");
+  if (size() + count > capacity()) {
+    reserve(growth_policy::next_capacity(capacity(), size() + count));
+  }
+  multi_uninitialized_copy_n(
+      std::make_tuple(firsts...), count,
+      arrays_at(size(), make_index_sequence<value_types_size>{}));
+  _base._size += count;
+}
+
+template <typename... T, class Traits>
+void multivector<types<T...>, Traits>::reallocate(size_type new_capacity,
+                                                  move_relocation_t) {
+  multivector_base_type new_base{get_allocator(), new_capacity, size()};
+  multi_uninitialized_move(_base._arrays, size(), new_base._arrays);
+  std::swap(_base, new_base);
+}
+
+template <typename... T, class Traits>
+void multivector<types<T...>, Traits>::reallocate(size_type new_capacity,
+                                                  in_place_relocation_t) {
+  _base.reallocate(new_capacity);
+}
+
+template <typename... T, class Traits>
+template <class... Args>
+void multivector<types<T...>, Traits>::grow_and_emplace_back(
+    std::tuple<Args...> &args, move_relocation_t) {
+  // `args` may refer to the elements of this multivector, so the new row has
+  // to be constructed before the old ones are moved away
+  size_type new_capacity = growth_policy::next_capacity(capacity(), size() + 1);
+  multivector_base_type new_base{get_allocator(), new_capacity, size()};
+  multi_uninitialized_emplace(new_base._arrays, size(), args);
+  multi_uninitialized_move(_base._arrays, size(), new_base._arrays);
+  std::swap(_base, new_base);
+}
+
+template <typename... T, class Traits>
+template <class... Args>
+void multivector<types<T...>, Traits>::grow_and_emplace_back(
+    std::tuple<Args...> &args, in_place_relocation_t) {
+  // `args` may refer to the elements of this multivector, so the row is
+  // constructed aside before the storage is reallocated
+  std::tuple<T...> values =
+      make_row(args, make_index_sequence<value_types_size>{});
+  reallocate(growth_policy::next_capacity(capacity(), size() + 1),
+             in_place_relocation_t{});
+  multi_uninitialized_emplace(_base._arrays, size(), values);
+}
+
 template <int I, typename multivector_type> struct swap_impl {
   using iterator = typename multivector_type::iterator;
   void operator()(multivector_type &v, iterator first, iterator second) {
@@ -489,5 +1144,191 @@ void multivector<types<T...>, Traits>::swap(iterator first, iterator second) {
   swap_impl<value_types_size - 1, multivector_type>{}(*this, first, second);
 }
 
+// erases the row at `position` by moving the last row in its place; returns
+// the former index of the moved row, which is `position`'s index if the last
+// row was erased
+template <typename... T, class Traits>
+auto multivector<types<T...>, Traits>::erase_unordered(iterator position)
+    -> size_type {
+  size_type index = *position;
+  size_type last_index = size() - 1;
+  assert(index < size());
+  if (index != last_index) {
+    multi_move_assign(_base._arrays, last_index, index);
+  }
+  multi_destroy(_base._arrays, last_index, size(), initialization_strategy);
+  --_base._size;
+  return last_index;
+}
+
+// erases the rows of the given indices, sorted in ascending order, like the
+// single row `erase_unordered`
+template <typename... T, class Traits>
+template <class BidirectionalIterator>
+void multivector<types<T...>, Traits>::erase_unordered(
+    BidirectionalIterator first, BidirectionalIterator last) {
+  erase_unordered(first, last, [](size_type, size_type) {});
+}
+
+// as above, calling `on_move(from_index, to_index)` for each moved row. The
+// holes below the new size are filled in ascending order with the highest
+// remaining rows, so every row is moved at most once.
+template <typename... T, class Traits>
+template <class BidirectionalIterator, class MoveObserver>
+void multivector<types<T...>, Traits>::erase_unordered(
+    BidirectionalIterator first, BidirectionalIterator last,
+    MoveObserver on_move) {
+  size_type old_size = size();
+  size_type new_size =
+      old_size - static_cast<size_type>(std::distance(first, last));
+  size_type source = old_size;
+  while (first != last && static_cast<size_type>(*first) < new_size) {
+    size_type hole = static_cast<size_type>(*first);
+    ++first;
+    assert(first == last || hole < static_cast<size_type>(*first));
+    // the erased rows at the end are skipped, they are between `first` and
+    // `last` as their indices are not below the new size
+    --source;
+    while (last != first &&
+           static_cast<size_type>(*std::prev(last)) == source) {
+      --last;
+      --source;
+    }
+    multi_move_assign(_base._arrays, source, hole);
+    on_move(source, hole);
+  }
+  multi_destroy(_base._arrays, new_size, old_size, initialization_strategy);
+  _base._size = new_size;
+}
+
+// removes the rows for which `pred` returns true and compacts the remaining
+// ones, keeping their order, in a single pass. `pred` is called with the
+// elements of the columns `I...` (all columns if none given). Returns the
+// number of removed rows.
+template <typename... T, class Traits>
+template <std::size_t... I, class Predicate>
+auto multivector<types<T...>, Traits>::remove_if(Predicate pred)
+    -> size_type {
+  return remove_if<I...>(pred, [](size_type, size_type) {});
+}
+
+// as above, calling `on_remap(old_index, new_index)` for each row whose index
+// changed, with `new_index` equal to `npos` for the removed rows
+template <typename... T, class Traits>
+template <std::size_t... I, class Predicate, class RemapObserver>
+auto multivector<types<T...>, Traits>::remove_if(Predicate pred,
+                                                 RemapObserver on_remap)
+    -> size_type {
+  using columns = typename std::conditional<
+      sizeof...(I) == 0, make_index_sequence<value_types_size>,
+      index_sequence<I...>>::type;
+
+  size_type old_size = size();
+  size_type new_size = 0;
+  size_type index = 0;
+  // `pred` is called once per row, its result is carried between the loops
+  bool removed = old_size != 0 && test_row(pred, index, columns{});
+  while (index < old_size) {
+    while (removed) {
+      on_remap(index, npos);
+      removed = ++index < old_size && test_row(pred, index, columns{});
+    }
+    // runs of kept rows are moved at once, column by column
+    size_type run_begin = index;
+    while (index < old_size && !removed) {
+      if (index != new_size + index - run_begin) {
+        on_remap(index, new_size + index - run_begin);
+      }
+      removed = ++index < old_size && test_row(pred, index, columns{});
+    }
+    if (run_begin != new_size) {
+      multi_move(_base._arrays, run_begin, index, new_size);
+    }
+    new_size += index - run_begin;
+  }
+  multi_destroy(_base._arrays, new_size, old_size, initialization_strategy);
+  _base._size = new_size;
+  return old_size - new_size;
+}
+
+template <typename... T, class Traits>
+template <class Predicate, std::size_t... I>
+bool multivector<types<T...>, Traits>::test_row(Predicate &pred,
+                                                size_type index,
+                                                index_sequence<I...>) {
+  return pred(const_cast<const value_type<I> &>(data<I>()[index])...);
+}
+
+template <typename... T, class Traits>
+template <std::size_t... I>
+auto multivector<types<T...>, Traits>::arrays_at(size_type index,
+                                                 index_sequence<I...>) noexcept
+    -> address_tuple {
+  return address_tuple{data<I>() + index...};
+}
+
+template <typename... T, class Traits>
+template <class... Args, std::size_t... I>
+auto multivector<types<T...>, Traits>::make_row(std::tuple<Args...> &args,
+                                                index_sequence<I...>)
+    -> std::tuple<T...> {
+  return std::tuple<T...>{T(std::forward<Args>(std::get<I>(args)))...};
+}
+
+// sorts the rows by the column `I`, stably; integral and floating point keys
+// are radix sorted. Floating point zeros of either sign compare equal and NaNs
+// are put last, where `std::less` would leave the order unspecified.
+// The sorting permutation is computed once and then applied to each column.
+template <typename... T, class Traits>
+template <std::size_t I>
+void multivector<types<T...>, Traits>::sort_by() {
+  sort_by_impl<I>(typename is_radix_sortable<value_type<I>>::type{});
+}
+
+// sorts the rows by the column `I`, stably, according to `comp`
+template <typename... T, class Traits>
+template <std::size_t I, class Compare>
+void multivector<types<T...>, Traits>::sort_by(Compare comp) {
+  const value_type<I> *keys = data<I>();
+  fast_vector<size_type> permutation(size());
+  for (size_type i = 0; i < size(); ++i) {
+    permutation.at(i) = i;
+  }
+  std::stable_sort(permutation.data(), permutation.data() + size(),
+                   [keys, &comp](size_type a, size_type b) {
+                     return comp(keys[a], keys[b]);
+                   });
+  multi_apply_permutation(_base._arrays, size(), permutation.data());
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+void multivector<types<T...>, Traits>::sort_by_impl(std::true_type) {
+  fast_vector<size_type> permutation(size());
+  radix_sort_permutation(data<I>(), size(), permutation.data());
+  multi_apply_permutation(_base._arrays, size(), permutation.data());
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+void multivector<types<T...>, Traits>::sort_by_impl(std::false_type) {
+  sort_by<I>(std::less<value_type<I>>{});
+}
+
+// sorts the rows by the column `I`, stably, with a radix sort split between
+// `thread_count` threads. The keys are scattered together with their row
+// indices, and each column is gathered only once, after the last pass.
+template <typename... T, class Traits>
+template <std::size_t I>
+void multivector<types<T...>, Traits>::parallel_sort_by(unsigned thread_count) {
+  static_assert(is_radix_sortable<value_type<I>>::value,
+                "Only integral and floating point keys can be radix sorted!");
+  thread_count = std::max(thread_count, 1u);
+  fast_vector<size_type> permutation(size());
+  radix_sort_permutation(data<I>(), size(), permutation.data(), thread_count);
+  multi_apply_permutation(_base._arrays, size(), permutation.data(),
+                          thread_count);
+}
+
 } // namespace tl
 } // namespace nete
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "utility.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace nete {
+namespace tl {
+
+// starts a `std::thread` running `f`
+struct thread_starter {
+  template <class F> std::thread operator()(F f) const {
+    return std::thread(std::move(f));
+  }
+};
+
+// splits [0, size) into `thread_count` contiguous chunks and calls
+// `f(chunk_index, first, last)` for each of them, each on its own thread
+// started with `start_thread`; the calling thread takes the first chunk. The
+// chunks depend only on `size` and `thread_count`, so consecutive calls split
+// the range in the same way. When a thread cannot be started, its chunk and
+// the following ones are run on the calling thread instead.
+template <class F, class ThreadStarter = thread_starter>
+void parallel_for_chunks(std::size_t size, unsigned thread_count, F f,
+                         ThreadStarter start_thread = ThreadStarter{}) {
+  if (thread_count <= 1) {
+    f(std::size_t{0}, std::size_t{0}, size);
+    return;
+  }
+  std::size_t chunk_size = div_ceil(size, std::size_t{thread_count});
+  auto run_chunk = [&f, size, chunk_size](unsigned chunk) {
+    std::size_t first = std::min(size, chunk * chunk_size);
+    std::size_t last = std::min(size, first + chunk_size);
+    f(std::size_t{chunk}, first, last);
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  // the started threads are joined before rethrowing an exception of `f`
+  try {
+    unsigned chunk = 1;
+    for (; chunk < thread_count; ++chunk) {
+      try {
+        threads.push_back(start_thread([&run_chunk, chunk]() {
+          run_chunk(chunk);
+        }));
+      } catch (const std::system_error &) {
+        break;
+      }
+    }
+    run_chunk(0);
+    for (; chunk < thread_count; ++chunk) {
+      run_chunk(chunk);
+    }
+  } catch (...) {
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+    throw;
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+}
+
+} // namespace tl
+} // namespace nete
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "fast_vector.h"
+#include "parallel.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace nete {
+namespace tl {
+
+// maps keys to unsigned integers of the same order, so they can be radix
+// sorted digit by digit
+template <typename Key, typename = void> struct radix_key_traits;
+
+template <typename Key>
+struct radix_key_traits<
+    Key, typename std::enable_if<std::is_integral<Key>::value &&
+                                 !std::is_same<Key, bool>::value>::type> {
+  using unsigned_type = typename std::make_unsigned<Key>::type;
+
+  static unsigned_type to_unsigned(Key key) {
+    // flipping the sign bit puts the negative numbers first
+    return static_cast<unsigned_type>(key) ^
+           (std::is_signed<Key>::value
+                ? static_cast<unsigned_type>(
+                      static_cast<unsigned_type>(1)
+                      << (std::numeric_limits<unsigned_type>::digits - 1))
+                : static_cast<unsigned_type>(0));
+  }
+};
+
+template <typename Key>
+struct radix_key_traits<
+    Key, typename std::enable_if<std::is_floating_point<Key>::value &&
+                                 std::numeric_limits<Key>::is_iec559 &&
+                                 (sizeof(Key) == 4 || sizeof(Key) == 8)>::type> {
+  using unsigned_type =
+      typename std::conditional<sizeof(Key) == 4, std::uint32_t,
+                                std::uint64_t>::type;
+
+  // -0.0 is mapped like 0.0, so the two stay in their original order as
+  // with `std::less`, and all NaNs are ordered after +infinity
+  static unsigned_type to_unsigned(Key key) {
+    constexpr unsigned_type sign_bit =
+        static_cast<unsigned_type>(1)
+        << (std::numeric_limits<unsigned_type>::digits - 1);
+    if (key != key) {
+      return std::numeric_limits<unsigned_type>::max();
+    }
+    if (key == Key(0)) {
+      key = Key(0);
+    }
+    unsigned_type bits;
+    std::memcpy(&bits, &key, sizeof(Key));
+    // negative numbers are ordered backwards by their magnitude bits
+    return bits & sign_bit ? ~bits : bits | sign_bit;
+  }
+};
+
+template <typename Key, typename = void>
+struct is_radix_sortable : std::false_type {};
+
+template <typename Key>
+struct is_radix_sortable<
+    Key, void_t<typename radix_key_traits<Key>::unsigned_type>>
+    : std::true_type {};
+
+// fills `permutation` with the indices of `keys` in the stable sorted order of
+// the keys, using an LSD radix sort with 8-bit digits. Each pass is split
+// between `thread_count` threads: every thread counts the digits in its chunk
+// of the keys, and after a prefix sum scatters the chunk to its own offsets.
+template <typename Key, typename SizeType>
+void radix_sort_permutation(const Key *keys, std::size_t size,
+                            SizeType *permutation, unsigned thread_count = 1) {
+  using unsigned_type = typename radix_key_traits<Key>::unsigned_type;
+  constexpr std::size_t digit_bits = 8;
+  constexpr std::size_t digit_values = std::size_t{1} << digit_bits;
+  constexpr std::size_t key_bits = std::numeric_limits<unsigned_type>::digits;
+
+  if (size == 0) {
+    return;
+  }
+  thread_count = static_cast<unsigned>(
+      std::max<std::size_t>(1, std::min<std::size_t>(thread_count, size)));
+
+  fast_vector<unsigned_type> radix_keys(size);
+  fast_vector<unsigned_type> radix_keys_buffer(size);
+  fast_vector<SizeType> permutation_buffer(size);
+  fast_vector<std::size_t> offsets(digit_values * thread_count);
+
+  unsigned_type *keys_in = radix_keys.data();
+  unsigned_type *keys_out = radix_keys_buffer.data();
+  SizeType *permutation_in = permutation;
+  SizeType *permutation_out = permutation_buffer.data();
+
+  parallel_for_chunks(size, thread_count, [&](std::size_t, std::size_t first,
+                                              std::size_t last) {
+    for (std::size_t i = first; i < last; ++i) {
+      keys_in[i] = radix_key_traits<Key>::to_unsigned(keys[i]);
+      permutation_in[i] = static_cast<SizeType>(i);
+    }
+  });
+
+  for (std::size_t shift = 0; shift < key_bits; shift += digit_bits) {
+    parallel_for_chunks(size, thread_count, [&](std::size_t chunk,
+                                                std::size_t first,
+                                                std::size_t last) {
+      std::size_t *chunk_offsets = offsets.data() + chunk * digit_values;
+      std::fill(chunk_offsets, chunk_offsets + digit_values, 0);
+      for (std::size_t i = first; i < last; ++i) {
+        ++chunk_offsets[(keys_in[i] >> shift) & (digit_values - 1)];
+      }
+    });
+
+    // a pass over a digit shared by all the keys would change nothing
+    std::size_t first_digit = (keys_in[0] >> shift) & (digit_values - 1);
+    std::size_t first_digit_count = 0;
+    for (unsigned chunk = 0; chunk < thread_count; ++chunk) {
+      first_digit_count += offsets.at(chunk * digit_values + first_digit);
+    }
+    if (first_digit_count == size) {
+      continue;
+    }
+
+    // chunks scatter their keys of a digit after the ones of earlier chunks
+    std::size_t offset = 0;
+    for (std::size_t digit = 0; digit < digit_values; ++digit) {
+      for (unsigned chunk = 0; chunk < thread_count; ++chunk) {
+        std::size_t &chunk_offset = offsets.at(chunk * digit_values + digit);
+        std::size_t count = chunk_offset;
+        chunk_offset = offset;
+        offset += count;
+      }
+    }
+
+    parallel_for_chunks(size, thread_count, [&](std::size_t chunk,
+                                                std::size_t first,
+                                                std::size_t last) {
+      std::size_t *chunk_offsets = offsets.data() + chunk * digit_values;
+      for (std::size_t i = first; i < last; ++i) {
+        std::size_t j =
+            chunk_offsets[(keys_in[i] >> shift) & (digit_values - 1)]++;
+        keys_out[j] = keys_in[i];
+        permutation_out[j] = permutation_in[i];
+      }
+    });
+
+    std::swap(keys_in, keys_out);
+    std::swap(permutation_in, permutation_out);
+  }
+
+  if (permutation_in != permutation) {
+    std::memcpy(permutation, permutation_in, sizeof(SizeType) * size);
+  }
+}
+
+} // namespace tl
+} // namespace nete
@@ -0,0 +1,655 @@
+#pragma once
+
+#include "memory.h"
+#include "multivector.h"
+#include "tiled_multivector.h"
+#include "type_traits.h"
+#include "utility.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace nete {
+namespace tl {
+
+struct segmented_multivector_traits {
+  using allocator_type = std::allocator<char>;
+  using size_type = size_t;
+  static constexpr bool disable_initialization = false;
+  // the number of rows in a segment, a power of two; the storage grows by
+  // whole segments, so this bounds the work done by a single push_back
+  static constexpr std::size_t segment_size = 16384;
+  static constexpr std::size_t column_alignment = 1;
+};
+
+// a segment of a segmented multivector: the storage it was allocated with and
+// the pointers to its columns
+template <typename... T> struct segmented_multivector_segment {
+  byte_type *storage;
+  std::tuple<T *...> arrays;
+};
+
+template <bool Const, typename Indices, typename... T>
+class segmented_multivector_iterator;
+
+// an iterator over the rows of chosen columns of a segmented multivector,
+// dereferencing to a tuple of references to the row's elements. It walks the
+// rows of a segment by a lane index and steps to the next segment at its end.
+template <bool Const, std::size_t... I, typename... T>
+class segmented_multivector_iterator<Const, index_sequence<I...>, T...>
+    : public std::iterator<
+          std::bidirectional_iterator_tag,
+          std::tuple<nth_type_of<I, T...>...>, std::ptrdiff_t, void,
+          std::tuple<typename std::conditional<
+              Const, const nth_type_of<I, T...>, nth_type_of<I, T...>>::type
+                         &...>> {
+public:
+  using base = std::iterator<
+      std::bidirectional_iterator_tag, std::tuple<nth_type_of<I, T...>...>,
+      std::ptrdiff_t, void,
+      std::tuple<typename std::conditional<Const, const nth_type_of<I, T...>,
+                                           nth_type_of<I, T...>>::type &...>>;
+  using reference = typename base::reference;
+  using segment_type = segmented_multivector_segment<T...>;
+  using size_type = std::size_t;
+
+  segmented_multivector_iterator(const segment_type *segment, size_type lane,
+                                 size_type segment_size)
+      : _segment(segment), _lane(lane), _segment_size(segment_size) {}
+
+  inline reference operator*() const {
+    return reference{std::get<I>(_segment->arrays)[_lane]...};
+  }
+
+  inline segmented_multivector_iterator &operator++() {
+    if (++_lane == _segment_size) {
+      ++_segment;
+      _lane = 0;
+    }
+    return *this;
+  }
+  inline segmented_multivector_iterator &operator--() {
+    if (_lane == 0) {
+      --_segment;
+      _lane = _segment_size;
+    }
+    --_lane;
+    return *this;
+  }
+  inline segmented_multivector_iterator operator++(int) {
+    segmented_multivector_iterator tmp(*this);
+    ++*this;
+    return tmp;
+  }
+  inline segmented_multivector_iterator operator--(int) {
+    segmented_multivector_iterator tmp(*this);
+    --*this;
+    return tmp;
+  }
+
+  inline bool operator==(const segmented_multivector_iterator &rhs) const {
+    return _segment == rhs._segment && _lane == rhs._lane;
+  }
+  inline bool operator!=(const segmented_multivector_iterator &rhs) const {
+    return !(*this == rhs);
+  }
+
+private:
+  const segment_type *_segment;
+  size_type _lane;
+  size_type _segment_size;
+};
+
+// a pair of iterators, usable in range-based for loops
+template <class Iterator> class segmented_multivector_range {
+public:
+  using iterator = Iterator;
+
+  segmented_multivector_range(iterator begin, iterator end)
+      : _begin(begin), _end(end) {}
+
+  iterator begin() const noexcept { return _begin; }
+  iterator end() const noexcept { return _end; }
+  bool empty() const noexcept { return _begin == _end; }
+
+private:
+  iterator _begin;
+  iterator _end;
+};
+
+template <typename Types, class Traits = segmented_multivector_traits>
+class segmented_multivector;
+
+// a multivector storing its rows in segments of `Traits::segment_size` rows,
+// each laid out like a multivector of that capacity. Segments are allocated
+// one at a time and never moved, so growing the multivector doesn't copy any
+// rows and the addresses of the elements stay valid until they are erased.
+template <typename... T, class Traits>
+class segmented_multivector<types<T...>, Traits> {
+public:
+  template <std::size_t I> using value_type = nth_type_of<I, T...>;
+  using value_types = types<T...>;
+  using allocator_type = typename Traits::allocator_type;
+  template <std::size_t I> using reference = value_type<I> &;
+  template <std::size_t I> using const_reference = const value_type<I> &;
+  using size_type = typename Traits::size_type;
+  using iterator = multivector_iterator<segmented_multivector>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  template <std::size_t... I>
+  using zip_range = segmented_multivector_range<
+      segmented_multivector_iterator<false, index_sequence<I...>, T...>>;
+  template <std::size_t... I>
+  using const_zip_range = segmented_multivector_range<
+      segmented_multivector_iterator<true, index_sequence<I...>, T...>>;
+  template <std::size_t I> using pointer = value_type<I> *;
+  template <std::size_t I> using const_pointer = const value_type<I> *;
+  using initialization_t =
+      typename std::conditional<Traits::disable_initialization,
+                                disable_initialization_t,
+                                enable_initialization_t>::type;
+  using address_tuple = std::tuple<T *...>;
+  using segment_type = segmented_multivector_segment<T...>;
+  using layout = multivector_layout<T...>;
+
+  static constexpr std::size_t value_types_size = value_types::size;
+  static constexpr size_type segment_size = Traits::segment_size;
+  static constexpr std::size_t column_alignment =
+      multivector_column_alignment<Traits>::value;
+  static constexpr std::size_t segment_alignment =
+      max_alignof<T...>::value > column_alignment ? max_alignof<T...>::value
+                                                  : column_alignment;
+  static constexpr std::size_t segment_storage_size =
+      tile_stride<segment_size, column_alignment, segment_alignment,
+                  T...>::value;
+  static constexpr std::size_t storage_padding =
+      segment_alignment > alignof(std::max_align_t) ? segment_alignment - 1
+                                                    : 0;
+
+  // the offset of the column `I` in a segment
+  template <std::size_t I>
+  using column_offset =
+      std::integral_constant<std::size_t,
+                             layout::offset_at(layout::positions[I],
+                                               segment_size, column_alignment)>;
+  static constexpr initialization_t initialization_strategy =
+      initialization_t{};
+
+  static_assert(value_types_size > 0, "");
+  static_assert(segment_size > 0 && (segment_size & (segment_size - 1)) == 0,
+                "Segment size must be a power of two!");
+  static_assert((column_alignment & (column_alignment - 1)) == 0,
+                "Column alignment must be a power of two!");
+  static_assert(!Traits::disable_initialization || are_trivial<T...>::value,
+                "Initialization can be disabled only for trivial types!");
+
+  explicit segmented_multivector(
+      const allocator_type &alloc = allocator_type{});
+  segmented_multivector(size_type size, const T &... values);
+  segmented_multivector(size_type size,
+                        const allocator_type &alloc = allocator_type{});
+  segmented_multivector(const segmented_multivector &x);
+  segmented_multivector(segmented_multivector &&x);
+  ~segmented_multivector();
+
+  segmented_multivector &operator=(const segmented_multivector &x);
+  segmented_multivector &operator=(segmented_multivector &&x);
+
+  allocator_type get_allocator() const noexcept;
+
+  template <std::size_t I> reference<I> at(size_type i);
+  template <std::size_t I> const_reference<I> at(size_type i) const;
+  template <std::size_t I> reference<I> get(iterator it);
+  template <std::size_t I> const_reference<I> get(iterator it) const;
+  template <std::size_t I> reference<I> get(reverse_iterator rit);
+  template <std::size_t I> const_reference<I> get(reverse_iterator rit) const;
+  template <std::size_t I> pointer<I> segment_data(size_type segment) noexcept;
+  template <std::size_t I>
+  const_pointer<I> segment_data(size_type segment) const noexcept;
+
+  iterator begin() noexcept;
+  iterator end() noexcept;
+  reverse_iterator rbegin() noexcept;
+  reverse_iterator rend() noexcept;
+  template <std::size_t... I> zip_range<I...> zip() noexcept;
+  template <std::size_t... I> const_zip_range<I...> zip() const noexcept;
+  template <std::size_t... I, class F> void for_each_segment(F f);
+
+  bool empty() const noexcept;
+  size_type size() const noexcept;
+  size_type segment_count() const noexcept;
+  void reserve(size_type requested_capacity);
+  size_type capacity() const noexcept;
+  void shrink_to_fit();
+
+  void clear() noexcept;
+  void push_back(const T &... values);
+  void emplace_back();
+  void pop_back();
+  void resize(size_type requested_size);
+  void resize(size_type requested_size, const T &... values);
+  void swap(iterator first, iterator second);
+
+private:
+  template <std::size_t... I>
+  static address_tuple segment_arrays(byte_type *segment_begin,
+                                      index_sequence<I...>);
+  template <class F, std::size_t... I>
+  void for_each_segment_impl(F &f, index_sequence<I...>);
+  template <class F>
+  void for_each_segment_rows(size_type first, size_type last, F f);
+  template <bool Const, std::size_t... I>
+  segmented_multivector_iterator<Const, index_sequence<I...>, T...>
+  zip_iterator(size_type index, index_sequence<I...>) const noexcept;
+  void allocate_segment();
+  void deallocate_segments(size_type first_segment);
+
+  allocator_type _allocator;
+  std::vector<segment_type> _segments;
+  size_type _size;
+};
+
+template <typename... T, class Traits>
+segmented_multivector<types<T...>, Traits>::segmented_multivector(
+    const allocator_type &alloc)
+    : _allocator(alloc), _size(0) {}
+
+template <typename... T, class Traits>
+segmented_multivector<types<T...>, Traits>::segmented_multivector(
+    size_type size, const T &... values)
+    : segmented_multivector() {
+  resize(size, values...);
+}
+
+template <typename... T, class Traits>
+segmented_multivector<types<T...>, Traits>::segmented_multivector(
+    size_type size, const allocator_type &alloc)
+    : segmented_multivector(alloc) {
+  resize(size);
+}
+
+template <typename... T, class Traits>
+segmented_multivector<types<T...>, Traits>::segmented_multivector(
+    const segmented_multivector &x)
+    : segmented_multivector(x.get_allocator()) {
+  reserve(x.size());
+  for_each_segment_rows(
+      0, x.size(), [&](address_tuple arrays, size_type segment, size_type,
+                       size_type last_lane) {
+        const std::tuple<const T *...> &x_arrays = x._segments[segment].arrays;
+        multi_uninitialized_copy(x_arrays, last_lane, arrays,
+                                 initialization_strategy);
+        _size += last_lane;
+      });
+}
+
+template <typename... T, class Traits>
+segmented_multivector<types<T...>, Traits>::segmented_multivector(
+    segmented_multivector &&x)
+    : _allocator(x._allocator), _segments(std::move(x._segments)),
+      _size(x._size) {
+  x._segments.clear();
+  x._size = 0;
+}
+
+template <typename... T, class Traits>
+segmented_multivector<types<T...>, Traits>::~segmented_multivector() {
+  clear();
+  deallocate_segments(0);
+}
+
+template <typename... T, class Traits>
+auto segmented_multivector<types<T...>, Traits>::operator=(
+    const segmented_multivector &x) -> segmented_multivector & {
+  segmented_multivector tmp{x};
+  std::swap(*this, tmp);
+  return *this;
+}
+
+template <typename... T, class Traits>
+auto segmented_multivector<types<T...>, Traits>::operator=(
+    segmented_multivector &&x) -> segmented_multivector & {
+  clear();
+  std::swap(_allocator, x._allocator);
+  std::swap(_segments, x._segments);
+  std::swap(_size, x._size);
+  return *this;
+}
+
+template <typename... T, class Traits>
+auto segmented_multivector<types<T...>, Traits>::get_allocator() const noexcept
+    -> allocator_type {
+  return _allocator;
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+auto segmented_multivector<types<T...>, Traits>::at(size_type i)
+    -> reference<I> {
+  return get<I>(iterator{i});
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+auto segmented_multivector<types<T...>, Traits>::at(size_type i) const
+    -> const_reference<I> {
+  return get<I>(iterator{i});
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+auto segmented_multivector<types<T...>, Traits>::get(iterator it)
+    -> reference<I> {
+  size_type index = *it;
+  assert(index < size());
+  return std::get<I>(_segments[index / segment_size].arrays)[index %
+                                                             segment_size];
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+auto segmented_multivector<types<T...>, Traits>::get(iterator it) const
+    -> const_reference<I> {
+  return const_cast<segmented_multivector *>(this)->template get<I>(it);
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+auto segmented_multivector<types<T...>, Traits>::get(reverse_iterator rit)
+    -> reference<I> {
+  return get<I>(rit.base() - 1);
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+auto segmented_multivector<types<T...>, Traits>::get(
+    reverse_iterator rit) const -> const_reference<I> {
+  return const_cast<segmented_multivector *>(this)->template get<I>(rit);
+}
+
+// the `segment_size` elements of column `I` in `segment`; only the ones of the
+// rows below `size()` are constructed
+template <typename... T, class Traits>
+template <std::size_t I>
+auto segmented_multivector<types<T...>, Traits>::segment_data(
+    size_type segment) noexcept -> pointer<I> {
+  assert(segment < _segments.size());
+  return std::get<I>(_segments[segment].arrays);
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+auto segmented_multivector<types<T...>, Traits>::segment_data(
+    size_type segment) const noexcept -> const_pointer<I> {
+  assert(segment < _segments.size());
+  return std::get<I>(_segments[segment].arrays);
+}
+
+template <typename... T, class Traits>
+auto segmented_multivector<types<T...>, Traits>::begin() noexcept
+    -> iterator {
+  return iterator{0};
+}
+
+template <typename... T, class Traits>
+auto segmented_multivector<types<T...>, Traits>::end() noexcept -> iterator {
+  return iterator{size()};
+}
+
+template <typename... T, class Traits>
+auto segmented_multivector<types<T...>, Traits>::rbegin() noexcept
+    -> reverse_iterator {
+  return std::reverse_iterator<iterator>{end()};
+}
+
+template <typename... T, class Traits>
+auto segmented_multivector<types<T...>, Traits>::rend() noexcept
+    -> reverse_iterator {
+  return std::reverse_iterator<iterator>{begin()};
+}
+
+template <typename... T, class Traits>
+template <std::size_t... I>
+auto segmented_multivector<types<T...>, Traits>::zip() noexcept
+    -> zip_range<I...> {
+  return zip_range<I...>{zip_iterator<false>(0, index_sequence<I...>{}),
+                         zip_iterator<false>(size(), index_sequence<I...>{})};
+}
+
+template <typename... T, class Traits>
+template <std::size_t... I>
+auto segmented_multivector<types<T...>, Traits>::zip() const noexcept
+    -> const_zip_range<I...> {
+  return const_zip_range<I...>{
+      zip_iterator<true>(0, index_sequence<I...>{}),
+      zip_iterator<true>(size(), index_sequence<I...>{})};
+}
+
+// calls `f(count, columns...)` for each segment holding rows, with pointers to
+// its first `count` elements of the columns `I...` (all columns if none
+// given). Within a segment the columns are contiguous, so this is the loop to
+// vectorize.
+template <typename... T, class Traits>
+template <std::size_t... I, class F>
+void segmented_multivector<types<T...>, Traits>::for_each_segment(F f) {
+  using columns = typename std::conditional<
+      sizeof...(I) == 0, make_index_sequence<value_types_size>,
+      index_sequence<I...>>::type;
+  for_each_segment_impl(f, columns{});
+}
+
+template <typename... T, class Traits>
+bool segmented_multivector<types<T...>, Traits>::empty() const noexcept {
+  return size() == 0;
+}
+
+template <typename... T, class Traits>
+auto segmented_multivector<types<T...>, Traits>::size() const noexcept
+    -> size_type {
+  return _size;
+}
+
+// the number of segments holding rows, the last one may be partially filled
+template <typename... T, class Traits>
+auto segmented_multivector<types<T...>, Traits>::segment_count() const
+    noexcept -> size_type {
+  return div_ceil(_size, segment_size);
+}
+
+// allocates the missing segments; no row is moved
+template <typename... T, class Traits>
+void segmented_multivector<types<T...>, Traits>::reserve(
+    size_type requested_capacity) {
+  size_type new_segment_count = div_ceil(requested_capacity, segment_size);
+  _segments.reserve(new_segment_count);
+  while (_segments.size() < new_segment_count) {
+    allocate_segment();
+  }
+}
+
+template <typename... T, class Traits>
+auto segmented_multivector<types<T...>, Traits>::capacity() const noexcept
+    -> size_type {
+  return _segments.size() * segment_size;
+}
+
+// releases the segments without rows
+template <typename... T, class Traits>
+void segmented_multivector<types<T...>, Traits>::shrink_to_fit() {
+  deallocate_segments(segment_count());
+  _segments.shrink_to_fit();
+}
+
+template <typename... T, class Traits>
+void segmented_multivector<types<T...>, Traits>::clear() noexcept {
+  resize(0);
+}
+
+template <typename... T, class Traits>
+void segmented_multivector<types<T...>, Traits>::push_back(
+    const T &... values) {
+  // the values may refer to the rows of this multivector, but growing it
+  // doesn't move them
+  if (_size == capacity()) {
+    allocate_segment();
+  }
+  size_type lane = _size % segment_size;
+  multi_uninitialized_fill(_segments[_size / segment_size].arrays, lane,
+                           lane + 1, std::tuple<const T &...>{values...},
+                           initialization_strategy);
+  ++_size;
+}
+
+template <typename... T, class Traits>
+void segmented_multivector<types<T...>, Traits>::emplace_back() {
+  if (_size == capacity()) {
+    allocate_segment();
+  }
+  size_type lane = _size % segment_size;
+  multi_uninitialized_construct(_segments[_size / segment_size].arrays, lane,
+                                lane + 1, initialization_strategy);
+  ++_size;
+}
+
+template <typename... T, class Traits>
+void segmented_multivector<types<T...>, Traits>::pop_back() {
+  assert(!empty());
+  --_size;
+  size_type lane = _size % segment_size;
+  multi_destroy(_segments[_size / segment_size].arrays, lane, lane + 1,
+                initialization_strategy);
+}
+
+template <typename... T, class Traits>
+void segmented_multivector<types<T...>, Traits>::resize(
+    size_type requested_size) {
+  if (requested_size < _size) {
+    for_each_segment_rows(requested_size, _size,
+                          [](address_tuple arrays, size_type,
+                             size_type first_lane, size_type last_lane) {
+                            multi_destroy(arrays, first_lane, last_lane,
+                                          initialization_strategy);
+                          });
+    _size = requested_size;
+    return;
+  }
+  reserve(requested_size);
+  for_each_segment_rows(_size, requested_size,
+                        [this](address_tuple arrays, size_type,
+                               size_type first_lane, size_type last_lane) {
+                          multi_uninitialized_construct(
+                              arrays, first_lane, last_lane,
+                              initialization_strategy);
+                          _size += last_lane - first_lane;
+                        });
+}
+
+template <typename... T, class Traits>
+void segmented_multivector<types<T...>, Traits>::resize(
+    size_type requested_size, const T &... values) {
+  if (requested_size <= _size) {
+    resize(requested_size);
+    return;
+  }
+  std::tuple<const T &...> values_tuple{values...};
+  reserve(requested_size);
+  for_each_segment_rows(_size, requested_size,
+                        [&](address_tuple arrays, size_type,
+                            size_type first_lane, size_type last_lane) {
+                          multi_uninitialized_fill(arrays, first_lane,
+                                                   last_lane, values_tuple,
+                                                   initialization_strategy);
+                          _size += last_lane - first_lane;
+                        });
+}
+
+template <typename... T, class Traits>
+void segmented_multivector<types<T...>, Traits>::swap(iterator first,
+                                                      iterator second) {
+  swap_impl<value_types_size - 1, segmented_multivector>{}(*this, first,
+                                                           second);
+}
+
+template <typename... T, class Traits>
+template <std::size_t... I>
+auto segmented_multivector<types<T...>, Traits>::segment_arrays(
+    byte_type *segment_begin, index_sequence<I...>) -> address_tuple {
+  return address_tuple{
+      reinterpret_cast<T *>(segment_begin + column_offset<I>::value)...};
+}
+
+template <typename... T, class Traits>
+template <class F, std::size_t... I>
+void segmented_multivector<types<T...>, Traits>::for_each_segment_impl(
+    F &f, index_sequence<I...>) {
+  for (size_type first = 0; first < _size; first += segment_size) {
+    size_type count = _size - first;
+    if (count > segment_size) {
+      count = segment_size;
+    }
+    f(count, std::get<I>(_segments[first / segment_size].arrays)...);
+  }
+}
+
+// calls `f(arrays, segment, first_lane, last_lane)` for the rows [first, last)
+// of every segment they span
+template <typename... T, class Traits>
+template <class F>
+void segmented_multivector<types<T...>, Traits>::for_each_segment_rows(
+    size_type first, size_type last, F f) {
+  while (first < last) {
+    size_type segment = first / segment_size;
+    size_type first_lane = first % segment_size;
+    size_type last_lane = first_lane + (last - first);
+    if (last_lane > segment_size) {
+      last_lane = segment_size;
+    }
+    f(_segments[segment].arrays, segment, first_lane, last_lane);
+    first += last_lane - first_lane;
+  }
+}
+
+template <typename... T, class Traits>
+template <bool Const, std::size_t... I>
+auto segmented_multivector<types<T...>, Traits>::zip_iterator(
+    size_type index, index_sequence<I...>) const noexcept
+    -> segmented_multivector_iterator<Const, index_sequence<I...>, T...> {
+  return segmented_multivector_iterator<Const, index_sequence<I...>, T...>{
+      _segments.data() + index / segment_size, index % segment_size,
+      segment_size};
+}
+
+template <typename... T, class Traits>
+void segmented_multivector<types<T...>, Traits>::allocate_segment() {
+  byte_type *storage =
+      _allocator.allocate(segment_storage_size + storage_padding);
+  try {
+    address_tuple arrays = segment_arrays(
+        align_up(storage, segment_alignment),
+        make_index_sequence<value_types_size>{});
+    _segments.push_back(segment_type{storage, arrays});
+  } catch (...) {
+    _allocator.deallocate(storage, segment_storage_size + storage_padding);
+    throw;
+  }
+}
+
+// releases the segments from `first_segment` on, which must hold no rows
+template <typename... T, class Traits>
+void segmented_multivector<types<T...>, Traits>::deallocate_segments(
+    size_type first_segment) {
+  assert(first_segment >= segment_count());
+  for (size_type segment = first_segment; segment < _segments.size();
+       ++segment) {
+    _allocator.deallocate(_segments[segment].storage,
+                          segment_storage_size + storage_padding);
+  }
+  _segments.resize(first_segment);
+}
+
+} // namespace tl
+} // namespace nete
@@ -0,0 +1,401 @@
+#pragma once
+
+#include "fast_vector.h"
+#include "memory.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace nete {
+namespace tl {
+
+// a fast_vector storing up to `N` elements in the object itself; the elements
+// are moved to a buffer from the allocator only when they don't fit there
+template <typename T, std::size_t N, class Allocator = std::allocator<T>,
+          class GrowthPolicy = geometric_growth<>>
+class small_fast_vector {
+public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using growth_policy = GrowthPolicy;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+  using size_type = std::size_t;
+  using iterator = fast_vector_iterator<T>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using pointer = value_type *;
+  using const_pointer = const value_type *;
+  using relocation_t =
+      typename std::conditional<allocator_has_reallocate<Allocator>::value,
+                                in_place_relocation_t,
+                                move_relocation_t>::type;
+
+  static constexpr size_type inline_capacity = N;
+
+  static_assert(std::is_trivial<T>::value,
+                "small_fast_vector supports only trivial types!");
+  static_assert(N > 0, "");
+
+  explicit small_fast_vector(const allocator_type &alloc = allocator_type{});
+  small_fast_vector(size_type size, const value_type &val,
+                    const allocator_type &alloc = allocator_type{});
+  small_fast_vector(size_type size,
+                    const allocator_type &alloc = allocator_type{});
+  small_fast_vector(const small_fast_vector &x);
+  small_fast_vector(small_fast_vector &&x);
+  ~small_fast_vector();
+
+  small_fast_vector &operator=(const small_fast_vector &x);
+  small_fast_vector &operator=(small_fast_vector &&x);
+
+  allocator_type get_allocator() const noexcept;
+
+  reference at(size_type i);
+  const_reference at(size_type i) const;
+  pointer data() noexcept;
+  const_pointer data() const noexcept;
+
+  iterator begin() noexcept;
+  iterator end() noexcept;
+  reverse_iterator rbegin() noexcept;
+  reverse_iterator rend() noexcept;
+
+  bool empty() const noexcept;
+  bool is_inline() const noexcept;
+  size_type size() const noexcept;
+  void reserve(size_type requested_capacity);
+  size_type capacity() const noexcept;
+  void shrink_to_fit();
+
+  void clear() noexcept;
+  void push_back(const value_type &val);
+  void emplace_back();
+  void pop_back();
+  void resize(size_type requested_size);
+  void resize(size_type requested_size, const value_type &val);
+  void resize_uninitialized(size_type requested_size);
+  void append(const_pointer values, size_type count);
+  iterator insert(iterator position, const_pointer first, const_pointer last);
+
+private:
+  pointer inline_data() noexcept;
+  void move_from(small_fast_vector &x) noexcept;
+  void reallocate(size_type new_capacity);
+  void reallocate(size_type new_capacity, move_relocation_t);
+  void reallocate(size_type new_capacity, in_place_relocation_t);
+  void grow(size_type required_capacity);
+
+  allocator_type _allocator;
+  T *_data;
+  size_type _size;
+  size_type _capacity;
+  typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type _buffer;
+};
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+small_fast_vector<T, N, Allocator, GrowthPolicy>::small_fast_vector(
+    const allocator_type &alloc)
+    : _allocator(alloc), _data(inline_data()), _size(0), _capacity(N) {}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+small_fast_vector<T, N, Allocator, GrowthPolicy>::small_fast_vector(
+    size_type size, const value_type &val, const allocator_type &alloc)
+    : small_fast_vector(alloc) {
+  resize(size, val);
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+small_fast_vector<T, N, Allocator, GrowthPolicy>::small_fast_vector(
+    size_type size, const allocator_type &alloc)
+    : small_fast_vector(alloc) {
+  resize(size);
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+small_fast_vector<T, N, Allocator, GrowthPolicy>::small_fast_vector(
+    const small_fast_vector &x)
+    : small_fast_vector(x.get_allocator()) {
+  reserve(x.size());
+  _size = x.size();
+  std::memcpy(data(), x.data(), sizeof(T) * size());
+}
+
+// the elements of `x` are copied if they are inline, and their buffer is
+// taken over otherwise
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+small_fast_vector<T, N, Allocator, GrowthPolicy>::small_fast_vector(
+    small_fast_vector &&x)
+    : small_fast_vector(x.get_allocator()) {
+  move_from(x);
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+small_fast_vector<T, N, Allocator, GrowthPolicy>::~small_fast_vector() {
+  if (!is_inline()) {
+    _allocator.deallocate(_data, _capacity);
+  }
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::operator=(
+    const small_fast_vector &x) -> small_fast_vector & {
+  if (this != &x) {
+    clear();
+    reserve(x.size());
+    _size = x.size();
+    std::memcpy(data(), x.data(), sizeof(T) * size());
+  }
+  return *this;
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::operator=(
+    small_fast_vector &&x) -> small_fast_vector & {
+  if (this != &x) {
+    reallocate(0, move_relocation_t{});
+    std::swap(_allocator, x._allocator);
+    move_from(x);
+  }
+  return *this;
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::get_allocator() const
+    noexcept -> allocator_type {
+  return _allocator;
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::at(size_type i)
+    -> reference {
+  return _data[i];
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::at(size_type i) const
+    -> const_reference {
+  return _data[i];
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::data() noexcept
+    -> pointer {
+  return _data;
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::data() const noexcept
+    -> const_pointer {
+  return _data;
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::begin() noexcept
+    -> iterator {
+  return iterator{data()};
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::end() noexcept
+    -> iterator {
+  return iterator{data() + size()};
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::rbegin() noexcept
+    -> reverse_iterator {
+  return std::reverse_iterator<iterator>{end()};
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::rend() noexcept
+    -> reverse_iterator {
+  return std::reverse_iterator<iterator>{begin()};
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+bool small_fast_vector<T, N, Allocator, GrowthPolicy>::empty() const noexcept {
+  return size() == 0;
+}
+
+// whether the elements are stored in the object itself
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+bool small_fast_vector<T, N, Allocator, GrowthPolicy>::is_inline() const
+    noexcept {
+  return _data == reinterpret_cast<const T *>(&_buffer);
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::size() const noexcept
+    -> size_type {
+  return _size;
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::reserve(
+    size_type requested_capacity) {
+  if (requested_capacity > capacity()) {
+    reallocate(requested_capacity);
+  }
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::capacity() const
+    noexcept -> size_type {
+  return _capacity;
+}
+
+// moves the elements back in the object if they fit there
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::shrink_to_fit() {
+  if (!is_inline() && size() < capacity()) {
+    reallocate(size());
+  }
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::clear() noexcept {
+  _size = 0;
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::push_back(
+    const value_type &val) {
+  if (size() == capacity()) {
+    // `val` may point into the buffer that is about to be released
+    value_type val_copy = val;
+    grow(size() + 1);
+    _data[_size++] = val_copy;
+  } else {
+    _data[_size++] = val;
+  }
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::emplace_back() {
+  if (size() == capacity()) {
+    grow(size() + 1);
+  }
+  ++_size;
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::pop_back() {
+  assert(!empty());
+  --_size;
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::resize(
+    size_type requested_size) {
+  reserve(requested_size);
+  _size = requested_size;
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::resize(
+    size_type requested_size, const value_type &val) {
+  auto old_size = size();
+  resize(requested_size);
+  if (requested_size > old_size) {
+    std::fill(begin() + old_size, begin() + requested_size, val);
+  }
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::inline_data() noexcept
+    -> pointer {
+  return reinterpret_cast<pointer>(&_buffer);
+}
+
+// takes the elements of `x`, leaving it empty; this must be inline and empty
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::move_from(
+    small_fast_vector &x) noexcept {
+  assert(is_inline() && empty());
+  if (x.is_inline()) {
+    std::memcpy(data(), x.data(), sizeof(T) * x.size());
+  } else {
+    _data = x._data;
+    _capacity = x._capacity;
+    x._data = x.inline_data();
+    x._capacity = N;
+  }
+  _size = x._size;
+  x._size = 0;
+}
+
+// the new elements are left uninitialized, e.g. to be written by a read from a
+// file or a socket
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::resize_uninitialized(
+    size_type requested_size) {
+  resize(requested_size);
+}
+
+// appends `count` elements copied from `values`, which may point into this
+// vector
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::append(
+    const_pointer values, size_type count) {
+  fast_vector_append(*this, values, count);
+}
+
+// inserts the elements [first, last), which may point into this vector,
+// before `position`; returns the iterator to the first inserted element
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+auto small_fast_vector<T, N, Allocator, GrowthPolicy>::insert(
+    iterator position, const_pointer first, const_pointer last) -> iterator {
+  return fast_vector_insert(*this, position, first, last);
+}
+
+// changes the capacity, keeping the first `min(_size, new_capacity)`
+// elements; a capacity not greater than `N` moves them in the object
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::reallocate(
+    size_type new_capacity) {
+  if (!is_inline() && new_capacity > N) {
+    reallocate(new_capacity, relocation_t{});
+  } else {
+    reallocate(new_capacity, move_relocation_t{});
+  }
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::reallocate(
+    size_type new_capacity, move_relocation_t) {
+  bool to_inline = new_capacity <= N;
+  T *new_data =
+      to_inline ? inline_data() : _allocator.allocate(new_capacity);
+  size_type new_size = std::min(_size, new_capacity);
+  if (new_data != _data && new_size) {
+    std::memcpy(new_data, _data, sizeof(T) * new_size);
+  }
+  if (!is_inline()) {
+    _allocator.deallocate(_data, _capacity);
+  }
+  _data = new_data;
+  _size = new_size;
+  _capacity = to_inline ? N : new_capacity;
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::reallocate(
+    size_type new_capacity, in_place_relocation_t) {
+  _data = _allocator.reallocate(_data, _capacity, new_capacity);
+  _capacity = new_capacity;
+  _size = std::min(_size, new_capacity);
+}
+
+template <typename T, std::size_t N, class Allocator, class GrowthPolicy>
+void small_fast_vector<T, N, Allocator, GrowthPolicy>::grow(
+    size_type required_capacity) {
+  reallocate(growth_policy::next_capacity(capacity(), required_capacity));
+}
+
+} // namespace tl
+} // namespace nete
@@ -0,0 +1,429 @@
+#pragma once
+
+#include "memory.h"
+#include "multivector.h"
+#include "type_traits.h"
+#include "utility.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+
+namespace nete {
+namespace tl {
+
+struct static_multivector_traits {
+  using size_type = size_t;
+  static constexpr bool disable_initialization = false;
+  static constexpr std::size_t column_alignment = 1;
+};
+
+template <typename Types, std::size_t N,
+          class Traits = static_multivector_traits>
+class static_multivector;
+
+// a multivector with a fixed capacity of `N` rows, stored inline. The offsets
+// of the columns are compile-time constants, so accessing a column doesn't
+// load any pointer, and the multivector never allocates.
+template <typename... T, std::size_t N, class Traits>
+class static_multivector<types<T...>, N, Traits> {
+public:
+  template <std::size_t I> using value_type = nth_type_of<I, T...>;
+  using value_types = types<T...>;
+  template <std::size_t I> using reference = value_type<I> &;
+  template <std::size_t I> using const_reference = const value_type<I> &;
+  using size_type = typename Traits::size_type;
+  using iterator = multivector_iterator<static_multivector>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  template <std::size_t... I>
+  using zip_range = multivector_zip_range<value_type<I>...>;
+  template <std::size_t... I>
+  using const_zip_range = multivector_zip_range<const value_type<I>...>;
+  template <std::size_t... I>
+  using view_type = multivector_view<value_type<I>...>;
+  template <std::size_t... I>
+  using const_view_type = multivector_view<const value_type<I>...>;
+  template <std::size_t I> using pointer = value_type<I> *;
+  template <std::size_t I> using const_pointer = const value_type<I> *;
+  using initialization_t =
+      typename std::conditional<Traits::disable_initialization,
+                                disable_initialization_t,
+                                enable_initialization_t>::type;
+  using address_tuple = std::tuple<T *...>;
+  using layout = multivector_layout<T...>;
+
+  static constexpr std::size_t value_types_size = value_types::size;
+  static constexpr size_type static_capacity = N;
+  static constexpr std::size_t column_alignment =
+      multivector_column_alignment<Traits>::value;
+  static constexpr std::size_t storage_alignment =
+      max_alignof<T...>::value > column_alignment ? max_alignof<T...>::value
+                                                  : column_alignment;
+  static constexpr std::size_t storage_size =
+      layout::storage_size(N, column_alignment);
+  static constexpr initialization_t initialization_strategy =
+      initialization_t{};
+
+  // the offset of the column `I` in the storage
+  template <std::size_t I>
+  using column_offset =
+      std::integral_constant<std::size_t,
+                             layout::offset_at(layout::positions[I], N,
+                                               column_alignment)>;
+
+  static_assert(value_types_size > 0, "");
+  static_assert(N > 0, "");
+  static_assert((column_alignment & (column_alignment - 1)) == 0,
+                "Column alignment must be a power of two!");
+  static_assert(!Traits::disable_initialization || are_trivial<T...>::value,
+                "Initialization can be disabled only for trivial types!");
+
+  static_multivector() noexcept;
+  explicit static_multivector(size_type size);
+  static_multivector(size_type size, const T &... values);
+  static_multivector(const static_multivector &x);
+  static_multivector(static_multivector &&x);
+  ~static_multivector();
+
+  static_multivector &operator=(const static_multivector &x);
+  static_multivector &operator=(static_multivector &&x);
+
+  template <std::size_t I> reference<I> at(size_type i);
+  template <std::size_t I> const_reference<I> at(size_type i) const;
+  template <std::size_t I> reference<I> get(iterator it);
+  template <std::size_t I> const_reference<I> get(iterator it) const;
+  template <std::size_t I> reference<I> get(reverse_iterator rit);
+  template <std::size_t I> const_reference<I> get(reverse_iterator rit) const;
+  template <std::size_t I> pointer<I> data() noexcept;
+  template <std::size_t I> const_pointer<I> data() const noexcept;
+  const byte_type *storage() const noexcept;
+
+  iterator begin() noexcept;
+  iterator end() noexcept;
+  reverse_iterator rbegin() noexcept;
+  reverse_iterator rend() noexcept;
+  template <std::size_t... I> zip_range<I...> zip() noexcept;
+  template <std::size_t... I> const_zip_range<I...> zip() const noexcept;
+  template <std::size_t... I> view_type<I...> view() noexcept;
+  template <std::size_t... I> const_view_type<I...> view() const noexcept;
+
+  bool empty() const noexcept;
+  bool full() const noexcept;
+  size_type size() const noexcept;
+  static constexpr size_type capacity() noexcept;
+
+  void clear() noexcept;
+  void push_back(const T &... values);
+  void emplace_back();
+  void pop_back();
+  void resize(size_type requested_size);
+  void resize(size_type requested_size, const T &... values);
+  void swap(iterator first, iterator second);
+  size_type erase_unordered(iterator position);
+
+private:
+  template <std::size_t... I> address_tuple arrays(index_sequence<I...>);
+  address_tuple arrays();
+
+  typename std::aligned_storage<storage_size, storage_alignment>::type
+      _storage;
+  size_type _size;
+};
+
+template <typename... T, std::size_t N, class Traits>
+static_multivector<types<T...>, N, Traits>::static_multivector() noexcept
+    : _size(0) {}
+
+template <typename... T, std::size_t N, class Traits>
+static_multivector<types<T...>, N, Traits>::static_multivector(size_type size)
+    : static_multivector() {
+  resize(size);
+}
+
+template <typename... T, std::size_t N, class Traits>
+static_multivector<types<T...>, N, Traits>::static_multivector(
+    size_type size, const T &... values)
+    : static_multivector() {
+  resize(size, values...);
+}
+
+template <typename... T, std::size_t N, class Traits>
+static_multivector<types<T...>, N, Traits>::static_multivector(
+    const static_multivector &x)
+    : static_multivector() {
+  const std::tuple<const T *...> &x_arrays =
+      const_cast<static_multivector &>(x).arrays();
+  multi_uninitialized_copy(x_arrays, x.size(), arrays(),
+                           initialization_strategy);
+  _size = x.size();
+}
+
+template <typename... T, std::size_t N, class Traits>
+static_multivector<types<T...>, N, Traits>::static_multivector(
+    static_multivector &&x)
+    : static_multivector() {
+  multi_uninitialized_move(x.arrays(), x.size(), arrays());
+  _size = x.size();
+  x._size = 0;
+}
+
+template <typename... T, std::size_t N, class Traits>
+static_multivector<types<T...>, N, Traits>::~static_multivector() {
+  clear();
+}
+
+template <typename... T, std::size_t N, class Traits>
+auto static_multivector<types<T...>, N, Traits>::operator=(
+    const static_multivector &x) -> static_multivector & {
+  static_multivector tmp{x};
+  *this = std::move(tmp);
+  return *this;
+}
+
+template <typename... T, std::size_t N, class Traits>
+auto static_multivector<types<T...>, N, Traits>::operator=(
+    static_multivector &&x) -> static_multivector & {
+  if (this != &x) {
+    clear();
+    multi_uninitialized_move(x.arrays(), x.size(), arrays());
+    _size = x.size();
+    x._size = 0;
+  }
+  return *this;
+}
+
+template <typename... T, std::size_t N, class Traits>
+template <std::size_t I>
+auto static_multivector<types<T...>, N, Traits>::at(size_type i)
+    -> reference<I> {
+  return get<I>(iterator{i});
+}
+
+template <typename... T, std::size_t N, class Traits>
+template <std::size_t I>
+auto static_multivector<types<T...>, N, Traits>::at(size_type i) const
+    -> const_reference<I> {
+  return get<I>(iterator{i});
+}
+
+template <typename... T, std::size_t N, class Traits>
+template <std::size_t I>
+auto static_multivector<types<T...>, N, Traits>::get(iterator it)
+    -> reference<I> {
+  size_type index = *it;
+  assert(index < size());
+  return data<I>()[index];
+}
+
+template <typename... T, std::size_t N, class Traits>
+template <std::size_t I>
+auto static_multivector<types<T...>, N, Traits>::get(iterator it) const
+    -> const_reference<I> {
+  return const_cast<static_multivector *>(this)->template get<I>(it);
+}
+
+template <typename... T, std::size_t N, class Traits>
+template <std::size_t I>
+auto static_multivector<types<T...>, N, Traits>::get(reverse_iterator rit)
+    -> reference<I> {
+  return get<I>(rit.base() - 1);
+}
+
+template <typename... T, std::size_t N, class Traits>
+template <std::size_t I>
+auto static_multivector<types<T...>, N, Traits>::get(
+    reverse_iterator rit) const -> const_reference<I> {
+  return const_cast<static_multivector *>(this)->template get<I>(rit);
+}
+
+template <typename... T, std::size_t N, class Traits>
+template <std::size_t I>
+auto static_multivector<types<T...>, N, Traits>::data() noexcept
+    -> pointer<I> {
+  return reinterpret_cast<pointer<I>>(reinterpret_cast<byte_type *>(&_storage) +
+                                      column_offset<I>::value);
+}
+
+template <typename... T, std::size_t N, class Traits>
+template <std::size_t I>
+auto static_multivector<types<T...>, N, Traits>::data() const noexcept
+    -> const_pointer<I> {
+  return const_cast<static_multivector *>(this)->template data<I>();
+}
+
+template <typename... T, std::size_t N, class Traits>
+const byte_type *static_multivector<types<T...>, N, Traits>::storage() const
+    noexcept {
+  return reinterpret_cast<const byte_type *>(&_storage);
+}
+
+template <typename... T, std::size_t N, class Traits>
+auto static_multivector<types<T...>, N, Traits>::begin() noexcept
+    -> iterator {
+  return iterator{0};
+}
+
+template <typename... T, std::size_t N, class Traits>
+auto static_multivector<types<T...>, N, Traits>::end() noexcept -> iterator {
+  return iterator{size()};
+}
+
+template <typename... T, std::size_t N, class Traits>
+auto static_multivector<types<T...>, N, Traits>::rbegin() noexcept
+    -> reverse_iterator {
+  return std::reverse_iterator<iterator>{end()};
+}
+
+template <typename... T, std::size_t N, class Traits>
+auto static_multivector<types<T...>, N, Traits>::rend() noexcept
+    -> reverse_iterator {
+  return std::reverse_iterator<iterator>{begin()};
+}
+
+template <typename... T, std::size_t N, class Traits>
+template <std::size_t... I>
+auto static_multivector<types<T...>, N, Traits>::zip() noexcept
+    -> zip_range<I...> {
+  return zip_range<I...>{std::make_tuple(data<I>()...), size()};
+}
+
+template <typename... T, std::size_t N, class Traits>
+template <std::size_t... I>
+auto static_multivector<types<T...>, N, Traits>::zip() const noexcept
+    -> const_zip_range<I...> {
+  return const_zip_range<I...>{std::make_tuple(data<I>()...), size()};
+}
+
+template <typename... T, std::size_t N, class Traits>
+template <std::size_t... I>
+auto static_multivector<types<T...>, N, Traits>::view() noexcept
+    -> view_type<I...> {
+  // the columns of a view are accessed through restrict-qualified pointers
+  static_assert(constexpr_distinct(I...),
+                "A mutable view cannot contain a column more than once!");
+  return view_type<I...>{std::make_tuple(data<I>()...), size()};
+}
+
+template <typename... T, std::size_t N, class Traits>
+template <std::size_t... I>
+auto static_multivector<types<T...>, N, Traits>::view() const noexcept
+    -> const_view_type<I...> {
+  return const_view_type<I...>{std::make_tuple(data<I>()...), size()};
+}
+
+template <typename... T, std::size_t N, class Traits>
+bool static_multivector<types<T...>, N, Traits>::empty() const noexcept {
+  return size() == 0;
+}
+
+template <typename... T, std::size_t N, class Traits>
+bool static_multivector<types<T...>, N, Traits>::full() const noexcept {
+  return size() == capacity();
+}
+
+template <typename... T, std::size_t N, class Traits>
+auto static_multivector<types<T...>, N, Traits>::size() const noexcept
+    -> size_type {
+  return _size;
+}
+
+template <typename... T, std::size_t N, class Traits>
+constexpr auto static_multivector<types<T...>, N, Traits>::capacity() noexcept
+    -> size_type {
+  return N;
+}
+
+template <typename... T, std::size_t N, class Traits>
+void static_multivector<types<T...>, N, Traits>::clear() noexcept {
+  resize(0);
+}
+
+// the multivector must not be full
+template <typename... T, std::size_t N, class Traits>
+void static_multivector<types<T...>, N, Traits>::push_back(
+    const T &... values) {
+  assert(!full());
+  multi_uninitialized_fill(arrays(), size(), size() + 1,
+                           std::tuple<const T &...>{values...},
+                           initialization_strategy);
+  ++_size;
+}
+
+template <typename... T, std::size_t N, class Traits>
+void static_multivector<types<T...>, N, Traits>::emplace_back() {
+  assert(!full());
+  multi_uninitialized_construct(arrays(), size(), size() + 1,
+                                initialization_strategy);
+  ++_size;
+}
+
+template <typename... T, std::size_t N, class Traits>
+void static_multivector<types<T...>, N, Traits>::pop_back() {
+  resize(size() - 1);
+}
+
+template <typename... T, std::size_t N, class Traits>
+void static_multivector<types<T...>, N, Traits>::resize(
+    size_type requested_size) {
+  assert(requested_size <= capacity());
+  if (requested_size > size()) {
+    multi_uninitialized_construct(arrays(), size(), requested_size,
+                                  initialization_strategy);
+  } else {
+    multi_destroy(arrays(), requested_size, size(), initialization_strategy);
+  }
+  _size = requested_size;
+}
+
+template <typename... T, std::size_t N, class Traits>
+void static_multivector<types<T...>, N, Traits>::resize(
+    size_type requested_size, const T &... values) {
+  assert(requested_size <= capacity());
+  if (requested_size > size()) {
+    multi_uninitialized_fill(arrays(), size(), requested_size,
+                             std::tuple<const T &...>{values...},
+                             initialization_strategy);
+  } else {
+    multi_destroy(arrays(), requested_size, size(), initialization_strategy);
+  }
+  _size = requested_size;
+}
+
+template <typename... T, std::size_t N, class Traits>
+void static_multivector<types<T...>, N, Traits>::swap(iterator first,
+                                                      iterator second) {
+  swap_impl<value_types_size - 1, static_multivector>{}(*this, first, second);
+}
+
+// erases the row at `position` by moving the last row in its place, like
+// `multivector::erase_unordered`
+template <typename... T, std::size_t N, class Traits>
+auto static_multivector<types<T...>, N, Traits>::erase_unordered(
+    iterator position) -> size_type {
+  size_type index = *position;
+  size_type last_index = size() - 1;
+  assert(index < size());
+  if (index != last_index) {
+    multi_move_assign(arrays(), last_index, index);
+  }
+  multi_destroy(arrays(), last_index, size(), initialization_strategy);
+  --_size;
+  return last_index;
+}
+
+template <typename... T, std::size_t N, class Traits>
+template <std::size_t... I>
+auto static_multivector<types<T...>, N, Traits>::arrays(index_sequence<I...>)
+    -> address_tuple {
+  return address_tuple{data<I>()...};
+}
+
+template <typename... T, std::size_t N, class Traits>
+auto static_multivector<types<T...>, N, Traits>::arrays() -> address_tuple {
+  return arrays(make_index_sequence<value_types_size>{});
+}
+
+} // namespace tl
+} // namespace nete
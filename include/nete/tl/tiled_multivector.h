@@ -0,0 +1,582 @@
+#pragma once
+
+#include "fast_vector.h"
+#include "memory.h"
+#include "multivector.h"
+#include "type_traits.h"
+#include "utility.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+
+namespace nete {
+namespace tl {
+
+// the distance between two consecutive tiles of `W` rows, such that every tile
+// is aligned to `TileAlignment`; the columns of a tile are laid out like in a
+// multivector
+template <std::size_t W, std::size_t ColumnAlignment,
+          std::size_t TileAlignment, typename... T>
+struct tile_stride
+    : std::integral_constant<
+          std::size_t,
+          (multivector_layout<T...>::storage_size(W, ColumnAlignment) +
+           TileAlignment - 1) /
+              TileAlignment * TileAlignment> {};
+
+struct tiled_multivector_traits {
+  using allocator_type = std::allocator<char>;
+  using size_type = size_t;
+  using growth_policy = geometric_growth<>;
+  static constexpr bool disable_initialization = false;
+  // the number of rows in a tile, a power of two; a SIMD kernel processes a
+  // column of a tile with `tile_width / lanes` full-width loads
+  static constexpr std::size_t tile_width = 8;
+  static constexpr std::size_t column_alignment = 1;
+};
+
+template <typename Types, class Traits = tiled_multivector_traits>
+class tiled_multivector;
+
+// a multivector with an AoSoA layout: the rows are grouped in tiles of
+// `Traits::tile_width` rows and every tile stores its columns one after
+// another. A row is then local to a tile, and the layout of the tiles doesn't
+// depend on the capacity, so trivial rows are relocated with a single copy.
+template <typename... T, class Traits>
+class tiled_multivector<types<T...>, Traits> {
+public:
+  template <std::size_t I> using value_type = nth_type_of<I, T...>;
+  using value_types = types<T...>;
+  using allocator_type = typename Traits::allocator_type;
+  using growth_policy = typename multivector_growth_policy<Traits>::type;
+  template <std::size_t I> using reference = value_type<I> &;
+  template <std::size_t I> using const_reference = const value_type<I> &;
+  using size_type = typename Traits::size_type;
+  using iterator = multivector_iterator<tiled_multivector>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  template <std::size_t I> using pointer = value_type<I> *;
+  template <std::size_t I> using const_pointer = const value_type<I> *;
+  using initialization_t =
+      typename std::conditional<Traits::disable_initialization,
+                                disable_initialization_t,
+                                enable_initialization_t>::type;
+  // the tiles of trivial types are moved with the storage
+  using relocation_t =
+      typename std::conditional<are_trivial<T...>::value,
+                                in_place_relocation_t,
+                                move_relocation_t>::type;
+  using storage_type = fast_vector<char, allocator_type>;
+  using address_tuple = std::tuple<T *...>;
+  using layout = multivector_layout<T...>;
+
+  static constexpr std::size_t value_types_size = value_types::size;
+  static constexpr size_type tile_width = Traits::tile_width;
+  static constexpr std::size_t column_alignment =
+      multivector_column_alignment<Traits>::value;
+  static constexpr std::size_t tile_alignment =
+      max_alignof<T...>::value > column_alignment ? max_alignof<T...>::value
+                                                  : column_alignment;
+  static constexpr std::size_t tile_size =
+      tile_stride<tile_width, column_alignment, tile_alignment,
+                  T...>::value;
+  static constexpr std::size_t storage_padding =
+      tile_alignment > alignof(std::max_align_t) ? tile_alignment - 1 : 0;
+
+  // the offset of the column `I` in a tile
+  template <std::size_t I>
+  using column_offset =
+      std::integral_constant<std::size_t,
+                             layout::offset_at(layout::positions[I],
+                                               tile_width, column_alignment)>;
+  static constexpr initialization_t initialization_strategy =
+      initialization_t{};
+  static constexpr relocation_t relocation_strategy = relocation_t{};
+
+  static_assert(value_types_size > 0, "");
+  static_assert(tile_width > 0 && (tile_width & (tile_width - 1)) == 0,
+                "Tile width must be a power of two!");
+  static_assert((column_alignment & (column_alignment - 1)) == 0,
+                "Column alignment must be a power of two!");
+  static_assert(!Traits::disable_initialization || are_trivial<T...>::value,
+                "Initialization can be disabled only for trivial types!");
+
+  explicit tiled_multivector(const allocator_type &alloc = allocator_type{});
+  tiled_multivector(size_type size, const T &... values);
+  tiled_multivector(size_type size,
+                    const allocator_type &alloc = allocator_type{});
+  tiled_multivector(const tiled_multivector &x);
+  tiled_multivector(tiled_multivector &&x);
+  ~tiled_multivector();
+
+  tiled_multivector &operator=(const tiled_multivector &x);
+  tiled_multivector &operator=(tiled_multivector &&x);
+
+  allocator_type get_allocator() const noexcept;
+
+  template <std::size_t I> reference<I> at(size_type i);
+  template <std::size_t I> const_reference<I> at(size_type i) const;
+  template <std::size_t I> reference<I> get(iterator it);
+  template <std::size_t I> const_reference<I> get(iterator it) const;
+  template <std::size_t I> reference<I> get(reverse_iterator rit);
+  template <std::size_t I> const_reference<I> get(reverse_iterator rit) const;
+  template <std::size_t I> pointer<I> tile_data(size_type tile) noexcept;
+  template <std::size_t I>
+  const_pointer<I> tile_data(size_type tile) const noexcept;
+
+  iterator begin() noexcept;
+  iterator end() noexcept;
+  reverse_iterator rbegin() noexcept;
+  reverse_iterator rend() noexcept;
+
+  bool empty() const noexcept;
+  size_type size() const noexcept;
+  size_type tile_count() const noexcept;
+  void reserve(size_type requested_capacity);
+  size_type capacity() const noexcept;
+  void shrink_to_fit();
+
+  void clear() noexcept;
+  void push_back(const T &... values);
+  void emplace_back();
+  void pop_back();
+  void resize(size_type requested_size);
+  void resize(size_type requested_size, const T &... values);
+  void swap(iterator first, iterator second);
+
+private:
+  template <std::size_t... I>
+  static address_tuple tile_arrays(byte_type *tiles, size_type tile,
+                                   index_sequence<I...>);
+  static address_tuple tile_arrays(byte_type *tiles, size_type tile);
+  template <class F> void for_each_tile(size_type first, size_type last, F f);
+  byte_type *tiles() noexcept;
+  const byte_type *tiles() const noexcept;
+
+  void reallocate(size_type new_tile_capacity, move_relocation_t);
+  void reallocate(size_type new_tile_capacity, in_place_relocation_t);
+  void grow_and_push_back(std::tuple<const T &...> values, move_relocation_t);
+  void grow_and_push_back(std::tuple<const T &...> values,
+                          in_place_relocation_t);
+
+  storage_type _storage;
+  size_type _tile_capacity;
+  size_type _size;
+};
+
+template <typename... T, class Traits>
+tiled_multivector<types<T...>, Traits>::tiled_multivector(
+    const allocator_type &alloc)
+    : _storage(alloc), _tile_capacity(0), _size(0) {}
+
+template <typename... T, class Traits>
+tiled_multivector<types<T...>, Traits>::tiled_multivector(size_type size,
+                                                          const T &... values)
+    : tiled_multivector() {
+  resize(size, values...);
+}
+
+template <typename... T, class Traits>
+tiled_multivector<types<T...>, Traits>::tiled_multivector(
+    size_type size, const allocator_type &alloc)
+    : tiled_multivector(alloc) {
+  resize(size);
+}
+
+template <typename... T, class Traits>
+tiled_multivector<types<T...>, Traits>::tiled_multivector(
+    const tiled_multivector &x)
+    : tiled_multivector(x.get_allocator()) {
+  reserve(x.size());
+  byte_type *x_tiles = const_cast<tiled_multivector &>(x).tiles();
+  for_each_tile(0, x.size(), [&](address_tuple arrays, size_type tile,
+                                 size_type, size_type last_lane) {
+    address_tuple x_arrays = tile_arrays(x_tiles, tile);
+    const std::tuple<const T *...> &x_const_arrays = x_arrays;
+    multi_uninitialized_copy(x_const_arrays, last_lane, arrays,
+                             initialization_strategy);
+    _size += last_lane;
+  });
+}
+
+template <typename... T, class Traits>
+tiled_multivector<types<T...>, Traits>::tiled_multivector(
+    tiled_multivector &&x)
+    : _storage(std::move(x._storage)), _tile_capacity(x._tile_capacity),
+      _size(x._size) {
+  x._tile_capacity = 0;
+  x._size = 0;
+}
+
+template <typename... T, class Traits>
+tiled_multivector<types<T...>, Traits>::~tiled_multivector() {
+  clear();
+}
+
+template <typename... T, class Traits>
+auto tiled_multivector<types<T...>, Traits>::operator=(
+    const tiled_multivector &x) -> tiled_multivector & {
+  tiled_multivector tmp{x};
+  std::swap(*this, tmp);
+  return *this;
+}
+
+template <typename... T, class Traits>
+auto tiled_multivector<types<T...>, Traits>::operator=(tiled_multivector &&x)
+    -> tiled_multivector & {
+  clear();
+  std::swap(_storage, x._storage);
+  std::swap(_tile_capacity, x._tile_capacity);
+  std::swap(_size, x._size);
+  return *this;
+}
+
+template <typename... T, class Traits>
+auto tiled_multivector<types<T...>, Traits>::get_allocator() const noexcept
+    -> allocator_type {
+  return _storage.get_allocator();
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+auto tiled_multivector<types<T...>, Traits>::at(size_type i) -> reference<I> {
+  return get<I>(iterator{i});
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+auto tiled_multivector<types<T...>, Traits>::at(size_type i) const
+    -> const_reference<I> {
+  return get<I>(iterator{i});
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+auto tiled_multivector<types<T...>, Traits>::get(iterator it) -> reference<I> {
+  size_type index = *it;
+  assert(index < size());
+  return tile_data<I>(index / tile_width)[index % tile_width];
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+auto tiled_multivector<types<T...>, Traits>::get(iterator it) const
+    -> const_reference<I> {
+  return const_cast<tiled_multivector *>(this)->template get<I>(it);
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+auto tiled_multivector<types<T...>, Traits>::get(reverse_iterator rit)
+    -> reference<I> {
+  return get<I>(rit.base() - 1);
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+auto tiled_multivector<types<T...>, Traits>::get(reverse_iterator rit) const
+    -> const_reference<I> {
+  return const_cast<tiled_multivector *>(this)->template get<I>(rit);
+}
+
+// the `tile_width` elements of column `I` in `tile`; only the lanes of the
+// rows below `size()` are constructed
+template <typename... T, class Traits>
+template <std::size_t I>
+auto tiled_multivector<types<T...>, Traits>::tile_data(size_type tile) noexcept
+    -> pointer<I> {
+  assert(tile < _tile_capacity);
+  return reinterpret_cast<pointer<I>>(
+      tiles() + tile * tile_size + column_offset<I>::value);
+}
+
+template <typename... T, class Traits>
+template <std::size_t I>
+auto tiled_multivector<types<T...>, Traits>::tile_data(size_type tile) const
+    noexcept -> const_pointer<I> {
+  return const_cast<tiled_multivector *>(this)->template tile_data<I>(tile);
+}
+
+template <typename... T, class Traits>
+auto tiled_multivector<types<T...>, Traits>::begin() noexcept -> iterator {
+  return iterator{0};
+}
+
+template <typename... T, class Traits>
+auto tiled_multivector<types<T...>, Traits>::end() noexcept -> iterator {
+  return iterator{size()};
+}
+
+template <typename... T, class Traits>
+auto tiled_multivector<types<T...>, Traits>::rbegin() noexcept
+    -> reverse_iterator {
+  return std::reverse_iterator<iterator>{end()};
+}
+
+template <typename... T, class Traits>
+auto tiled_multivector<types<T...>, Traits>::rend() noexcept
+    -> reverse_iterator {
+  return std::reverse_iterator<iterator>{begin()};
+}
+
+template <typename... T, class Traits>
+bool tiled_multivector<types<T...>, Traits>::empty() const noexcept {
+  return size() == 0;
+}
+
+template <typename... T, class Traits>
+auto tiled_multivector<types<T...>, Traits>::size() const noexcept
+    -> size_type {
+  return _size;
+}
+
+// the number of tiles holding rows, the last one may be partially filled
+template <typename... T, class Traits>
+auto tiled_multivector<types<T...>, Traits>::tile_count() const noexcept
+    -> size_type {
+  return div_ceil(_size, tile_width);
+}
+
+template <typename... T, class Traits>
+void tiled_multivector<types<T...>, Traits>::reserve(
+    size_type requested_capacity) {
+  size_type new_tile_capacity = div_ceil(requested_capacity, tile_width);
+  if (new_tile_capacity > _tile_capacity) {
+    reallocate(new_tile_capacity, relocation_strategy);
+  }
+}
+
+template <typename... T, class Traits>
+auto tiled_multivector<types<T...>, Traits>::capacity() const noexcept
+    -> size_type {
+  return _tile_capacity * tile_width;
+}
+
+template <typename... T, class Traits>
+void tiled_multivector<types<T...>, Traits>::shrink_to_fit() {
+  if (tile_count() < _tile_capacity) {
+    reallocate(tile_count(), relocation_strategy);
+  }
+}
+
+template <typename... T, class Traits>
+void tiled_multivector<types<T...>, Traits>::clear() noexcept {
+  for_each_tile(0, _size, [](address_tuple arrays, size_type,
+                             size_type first_lane, size_type last_lane) {
+    multi_destroy(arrays, first_lane, last_lane, initialization_strategy);
+  });
+  _size = 0;
+}
+
+template <typename... T, class Traits>
+void tiled_multivector<types<T...>, Traits>::push_back(const T &... values) {
+  std::tuple<const T &...> values_tuple{values...};
+  if (_size == capacity()) {
+    grow_and_push_back(values_tuple, relocation_strategy);
+    return;
+  }
+  size_type lane = _size % tile_width;
+  multi_uninitialized_fill(tile_arrays(tiles(), _size / tile_width), lane,
+                           lane + 1, values_tuple, initialization_strategy);
+  ++_size;
+}
+
+template <typename... T, class Traits>
+void tiled_multivector<types<T...>, Traits>::emplace_back() {
+  if (_size == capacity()) {
+    reserve(growth_policy::next_capacity(capacity(), _size + 1));
+  }
+  size_type lane = _size % tile_width;
+  multi_uninitialized_construct(tile_arrays(tiles(), _size / tile_width), lane,
+                                lane + 1, initialization_strategy);
+  ++_size;
+}
+
+template <typename... T, class Traits>
+void tiled_multivector<types<T...>, Traits>::pop_back() {
+  assert(!empty());
+  --_size;
+  size_type lane = _size % tile_width;
+  multi_destroy(tile_arrays(tiles(), _size / tile_width), lane, lane + 1,
+                initialization_strategy);
+}
+
+template <typename... T, class Traits>
+void tiled_multivector<types<T...>, Traits>::resize(size_type requested_size) {
+  if (requested_size < _size) {
+    for_each_tile(requested_size, _size,
+                  [](address_tuple arrays, size_type, size_type first_lane,
+                     size_type last_lane) {
+                    multi_destroy(arrays, first_lane, last_lane,
+                                  initialization_strategy);
+                  });
+    _size = requested_size;
+    return;
+  }
+  reserve(requested_size);
+  for_each_tile(_size, requested_size,
+                [this](address_tuple arrays, size_type, size_type first_lane,
+                       size_type last_lane) {
+                  multi_uninitialized_construct(arrays, first_lane, last_lane,
+                                                initialization_strategy);
+                  _size += last_lane - first_lane;
+                });
+}
+
+template <typename... T, class Traits>
+void tiled_multivector<types<T...>, Traits>::resize(size_type requested_size,
+                                                    const T &... values) {
+  if (requested_size <= _size) {
+    resize(requested_size);
+    return;
+  }
+  // the values may be rows of this multivector
+  std::tuple<T...> values_copy{values...};
+  const std::tuple<const T &...> &values_tuple = values_copy;
+  reserve(requested_size);
+  for_each_tile(_size, requested_size,
+                [&](address_tuple arrays, size_type, size_type first_lane,
+                    size_type last_lane) {
+                  multi_uninitialized_fill(arrays, first_lane, last_lane,
+                                           values_tuple,
+                                           initialization_strategy);
+                  _size += last_lane - first_lane;
+                });
+}
+
+template <typename... T, class Traits>
+void tiled_multivector<types<T...>, Traits>::swap(iterator first,
+                                                  iterator second) {
+  swap_impl<value_types_size - 1, tiled_multivector>{}(*this, first, second);
+}
+
+template <typename... T, class Traits>
+template <std::size_t... I>
+auto tiled_multivector<types<T...>, Traits>::tile_arrays(byte_type *tiles,
+                                                         size_type tile,
+                                                         index_sequence<I...>)
+    -> address_tuple {
+  byte_type *tile_begin = tiles + tile * tile_size;
+  return address_tuple{
+      reinterpret_cast<T *>(tile_begin + column_offset<I>::value)...};
+}
+
+template <typename... T, class Traits>
+auto tiled_multivector<types<T...>, Traits>::tile_arrays(byte_type *tiles,
+                                                         size_type tile)
+    -> address_tuple {
+  return tile_arrays(tiles, tile, make_index_sequence<value_types_size>{});
+}
+
+// calls `f(arrays, tile, first_lane, last_lane)` for the rows [first, last) of
+// every tile they span
+template <typename... T, class Traits>
+template <class F>
+void tiled_multivector<types<T...>, Traits>::for_each_tile(size_type first,
+                                                           size_type last,
+                                                           F f) {
+  while (first < last) {
+    size_type tile = first / tile_width;
+    size_type first_lane = first % tile_width;
+    size_type last_lane = first_lane + (last - first);
+    if (last_lane > tile_width) {
+      last_lane = tile_width;
+    }
+    f(tile_arrays(tiles(), tile), tile, first_lane, last_lane);
+    first += last_lane - first_lane;
+  }
+}
+
+template <typename... T, class Traits>
+byte_type *tiled_multivector<types<T...>, Traits>::tiles() noexcept {
+  return storage_padding ? align_up(_storage.data(), tile_alignment)
+                         : _storage.data();
+}
+
+template <typename... T, class Traits>
+const byte_type *tiled_multivector<types<T...>, Traits>::tiles() const
+    noexcept {
+  return const_cast<tiled_multivector *>(this)->tiles();
+}
+
+template <typename... T, class Traits>
+void tiled_multivector<types<T...>, Traits>::reallocate(
+    size_type new_tile_capacity, move_relocation_t) {
+  assert(new_tile_capacity >= tile_count());
+  storage_type new_storage{get_allocator()};
+  if (new_tile_capacity) {
+    new_storage.resize(new_tile_capacity * tile_size + storage_padding);
+  }
+  byte_type *new_tiles = align_up(new_storage.data(), tile_alignment);
+  for_each_tile(0, _size, [new_tiles](address_tuple arrays, size_type tile,
+                                      size_type, size_type last_lane) {
+    multi_uninitialized_move(arrays, last_lane, tile_arrays(new_tiles, tile));
+  });
+  std::swap(_storage, new_storage);
+  _tile_capacity = new_tile_capacity;
+}
+
+// the tiles are copied bytewise by the storage, possibly without moving them
+// at all; only a change of the padding shifts them
+template <typename... T, class Traits>
+void tiled_multivector<types<T...>, Traits>::reallocate(
+    size_type new_tile_capacity, in_place_relocation_t) {
+  assert(new_tile_capacity >= tile_count());
+  std::size_t padding = tiles() - _storage.data();
+  _storage.resize(new_tile_capacity ? new_tile_capacity * tile_size +
+                                          storage_padding
+                                    : 0);
+  if (new_tile_capacity < _tile_capacity) {
+    _storage.shrink_to_fit();
+  }
+  _tile_capacity = new_tile_capacity;
+  std::size_t new_padding = tiles() - _storage.data();
+  if (new_padding != padding && _size) {
+    std::memmove(_storage.data() + new_padding, _storage.data() + padding,
+                 tile_count() * tile_size);
+  }
+}
+
+// the new row is constructed before the old rows are moved, since the values
+// may refer to them
+template <typename... T, class Traits>
+void tiled_multivector<types<T...>, Traits>::grow_and_push_back(
+    std::tuple<const T &...> values, move_relocation_t) {
+  size_type new_tile_capacity = div_ceil(
+      growth_policy::next_capacity(capacity(), _size + 1), tile_width);
+  storage_type new_storage{get_allocator()};
+  new_storage.resize(new_tile_capacity * tile_size + storage_padding);
+  byte_type *new_tiles = align_up(new_storage.data(), tile_alignment);
+  size_type lane = _size % tile_width;
+  multi_uninitialized_fill(tile_arrays(new_tiles, _size / tile_width), lane,
+                           lane + 1, values, initialization_strategy);
+  for_each_tile(0, _size, [new_tiles](address_tuple arrays, size_type tile,
+                                      size_type, size_type last_lane) {
+    multi_uninitialized_move(arrays, last_lane, tile_arrays(new_tiles, tile));
+  });
+  std::swap(_storage, new_storage);
+  _tile_capacity = new_tile_capacity;
+  ++_size;
+}
+
+template <typename... T, class Traits>
+void tiled_multivector<types<T...>, Traits>::grow_and_push_back(
+    std::tuple<const T &...> values, in_place_relocation_t) {
+  std::tuple<T...> values_copy{values};
+  reallocate(div_ceil(growth_policy::next_capacity(capacity(), _size + 1),
+                      tile_width),
+             relocation_strategy);
+  size_type lane = _size % tile_width;
+  const std::tuple<const T &...> &values_copy_refs = values_copy;
+  multi_uninitialized_fill(tile_arrays(tiles(), _size / tile_width), lane,
+                           lane + 1, values_copy_refs,
+                           initialization_strategy);
+  ++_size;
+}
+
+} // namespace tl
+} // namespace nete
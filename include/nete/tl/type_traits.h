@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
 #include <type_traits>
 
 namespace nete {
@@ -11,5 +13,39 @@ struct are_trivial
 
 template <typename Head> struct are_trivial<Head> : std::is_trivial<Head> {};
 
+// whether moving an object to a new address and ending the lifetime of the
+// old one can be done by copying its bytes. Trivially copyable types qualify;
+// other types can opt in by specializing this trait.
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+template <typename Head, typename... Tail>
+struct are_trivially_relocatable
+    : std::integral_constant<bool,
+                             is_trivially_relocatable<Head>::value &&
+                                 are_trivially_relocatable<Tail...>::value> {};
+
+template <typename Head>
+struct are_trivially_relocatable<Head> : is_trivially_relocatable<Head> {};
+
+// the strictest alignment of the given types
+template <typename Head, typename... Tail>
+struct max_alignof
+    : std::integral_constant<std::size_t,
+                             (alignof(Head) > max_alignof<Tail...>::value
+                                  ? alignof(Head)
+                                  : max_alignof<Tail...>::value)> {};
+
+template <typename Head>
+struct max_alignof<Head> : std::integral_constant<std::size_t, alignof(Head)> {
+};
+
+// std::void_t backport, used for detecting optional members of traits
+template <typename... T> struct make_void { using type = void; };
+template <typename... T> using void_t = typename make_void<T...>::type;
+
 } // namespace tl
 } // namespace nete
@@ -2,10 +2,18 @@
 
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <tuple>
 #include <type_traits>
 #include <vector>
 
+// marks pointers that don't alias any other pointer in their scope
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#define NETE_RESTRICT __restrict
+#else
+#define NETE_RESTRICT
+#endif
+
 namespace nete {
 namespace tl {
 
@@ -28,6 +36,49 @@ template <typename... T> struct types {
   static constexpr std::size_t size = std::tuple_size<std::tuple<T...>>::value;
 };
 
+// std::index_sequence backport
+template <std::size_t... I> struct index_sequence {};
+
+template <std::size_t N, std::size_t... I>
+struct make_index_sequence_impl : make_index_sequence_impl<N - 1, N - 1, I...> {
+};
+
+template <std::size_t... I> struct make_index_sequence_impl<0, I...> {
+  using type = index_sequence<I...>;
+};
+
+template <std::size_t N>
+using make_index_sequence = typename make_index_sequence_impl<N>::type;
+
+// evaluates the expressions of a pack expansion, e.g. `swallow{(++p, 0)...}`
+using swallow = int[];
+
+// the sum of the arguments, usable in constant expressions
+constexpr std::size_t constexpr_sum() { return 0; }
+
+template <typename... Tail>
+constexpr std::size_t constexpr_sum(std::size_t head, Tail... tail) {
+  return head + constexpr_sum(tail...);
+}
+
+// whether `value` differs from all the other arguments, usable in constant
+// expressions
+constexpr bool constexpr_none_equal(std::size_t) { return true; }
+
+template <typename... Tail>
+constexpr bool constexpr_none_equal(std::size_t value, std::size_t head,
+                                    Tail... tail) {
+  return value != head && constexpr_none_equal(value, tail...);
+}
+
+// whether the arguments are pairwise distinct, usable in constant expressions
+constexpr bool constexpr_distinct() { return true; }
+
+template <typename... Tail>
+constexpr bool constexpr_distinct(std::size_t head, Tail... tail) {
+  return constexpr_none_equal(head, tail...) && constexpr_distinct(tail...);
+}
+
 // a ceiling of integer division
 template <typename T> T div_ceil(T a, T b) {
   assert(a >= 0 && b > 0);
@@ -39,6 +90,13 @@ template <typename T> T next_multiple_of_gte(T n, T base) {
   return base * div_ceil(n, base);
 }
 
+// `ptr` rounded up to the next multiple of `alignment`, a power of two
+template <typename T> T *align_up(T *ptr, std::size_t alignment) {
+  assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+  std::uintptr_t address = reinterpret_cast<std::uintptr_t>(ptr);
+  return reinterpret_cast<T *>((address + alignment - 1) & ~(alignment - 1));
+}
+
 template <std::size_t N, typename Tuple> struct sizeof_tuple_head;
 
 template <std::size_t N, typename... Args>
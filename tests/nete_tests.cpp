@@ -4,4 +4,370 @@
 
 #include <nete/nete.h>
 
-TEST_CASE("Component", "[component]") { using namespace nete; }
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+TEST_CASE("Component", "[component]") {
+  using namespace nete;
+
+  using component_type = Component<Chunks<int, std::string>>;
+
+  SECTION("insert") {
+    component_type c;
+
+    REQUIRE(c.empty());
+
+    c.insert(7, 70, "seven");
+    c.insert(3, 30, "three");
+    c.emplace(100, 1000, "hundred");
+
+    REQUIRE(c.size() == 3);
+    REQUIRE(c.has(7));
+    REQUIRE(c.has(3));
+    REQUIRE(c.has(100));
+    REQUIRE(!c.has(0));
+    REQUIRE(!c.has(8));
+    REQUIRE(!c.has(1000));
+
+    REQUIRE(c.at<0>(7) == 70);
+    REQUIRE(c.at<1>(3) == "three");
+    REQUIRE(c.at<1>(100) == "hundred");
+
+    c.at<0>(3) = 31;
+
+    REQUIRE(c.get<0>(c.find(3)) == 31);
+    REQUIRE(c.find(8) == c.end());
+  }
+
+  SECTION("iteration") {
+    component_type c;
+
+    for (int i = 0; i < 10; ++i) {
+      c.insert(i * 2, i, std::to_string(i));
+    }
+
+    int sum = 0;
+    for (auto it = c.begin(); it != c.end(); ++it) {
+      REQUIRE(c.entity(it) == c.get<0>(it) * 2);
+      sum += c.get<0>(it);
+    }
+
+    REQUIRE(sum == 45);
+    REQUIRE(c.entities()[4] == 8);
+    REQUIRE(c.data<0>()[4] == 4);
+  }
+
+  SECTION("erase") {
+    component_type c;
+
+    for (int i = 0; i < 10; ++i) {
+      c.insert(i, i, std::to_string(i));
+    }
+
+    c.erase(2);
+    c.erase(9);
+    c.erase(0);
+
+    REQUIRE(c.size() == 7);
+    REQUIRE(!c.has(0));
+    REQUIRE(!c.has(2));
+    REQUIRE(!c.has(9));
+
+    for (int i : {1, 3, 4, 5, 6, 7, 8}) {
+      REQUIRE(c.has(i));
+      REQUIRE(c.at<0>(i) == i);
+      REQUIRE(c.at<1>(i) == std::to_string(i));
+      REQUIRE(c.entity(c.find(i)) == i);
+    }
+
+    c.insert(2, 20, "twenty");
+
+    REQUIRE(c.at<0>(2) == 20);
+
+    c.clear();
+
+    REQUIRE(c.empty());
+    REQUIRE(!c.has(1));
+  }
+
+  SECTION("single chunk") {
+    Component<double> c;
+
+    c.insert(5, 0.5);
+
+    REQUIRE(c.at<0>(5) == 0.5);
+  }
+
+  SECTION("tags") {
+    struct Tag {};
+
+    Component<Tag> tags;
+
+    static_assert(std::is_same<decltype(tags)::storage_type,
+                               tl::multivector<tl::types<std::uint32_t>,
+                                               DefaultComponentTraits>>::value,
+                  "");
+
+    tags.emplace(3);
+    tags.insert(8, Tag{});
+    tags.emplace(5);
+    tags.erase(3);
+
+    REQUIRE(tags.size() == 2);
+    REQUIRE(tags.has(8));
+    REQUIRE(tags.has(5));
+    REQUIRE(!tags.has(3));
+    REQUIRE(tags.entities()[0] == 5);
+    REQUIRE(tags.entities()[1] == 8);
+  }
+
+  SECTION("chunks mixed with tags") {
+    struct Tag {};
+
+    Component<Chunks<Tag, int, Tag, std::string>> c;
+
+    static_assert(decltype(c)::storage_type::value_types::size == 3, "");
+
+    c.insert(1, Tag{}, 10, Tag{}, "one");
+    c.emplace(2, Tag{}, 20, Tag{}, "two");
+    c.emplace(3);
+
+    REQUIRE(c.at<1>(1) == 10);
+    REQUIRE(c.at<3>(2) == "two");
+    REQUIRE(c.at<1>(3) == 0);
+    REQUIRE(c.data<3>()[0] == "one");
+
+    Tag &tag = c.get<2>(c.find(2));
+    (void)tag;
+  }
+}
+
+TEST_CASE("PagedSparseArray", "[mapping]") {
+  using namespace nete;
+
+  using array_type = PagedSparseArray<std::uint32_t, 16>;
+
+  SECTION("pages are allocated lazily") {
+    array_type a;
+
+    REQUIRE(a.find(0) == array_type::npos);
+    REQUIRE(a.find(1000000) == array_type::npos);
+
+    a.insert(1000000, 1);
+    a.insert(1000001, 2);
+    a.insert(3, 3);
+
+    REQUIRE(a.page_count() == 2);
+    REQUIRE(a.find(1000000) == 1);
+    REQUIRE(a.find(1000001) == 2);
+    REQUIRE(a.find(3) == 3);
+    REQUIRE(a.find(4) == array_type::npos);
+    REQUIRE(a.find(500000) == array_type::npos);
+  }
+
+  SECTION("empty pages are freed") {
+    array_type a;
+
+    a.insert(40, 0);
+    a.insert(41, 1);
+    a.insert(41, 2);
+    a.erase(40);
+
+    REQUIRE(a.page_count() == 1);
+    REQUIRE(a.find(41) == 2);
+
+    a.erase(41);
+
+    REQUIRE(a.page_count() == 0);
+    REQUIRE(a.find(41) == array_type::npos);
+
+    a.insert(41, 3);
+
+    REQUIRE(a.find(41) == 3);
+  }
+
+  SECTION("copy") {
+    array_type a;
+
+    a.insert(5, 50);
+    a.insert(100, 1000);
+
+    array_type b{a};
+    a.erase(5);
+
+    REQUIRE(b.find(5) == 50);
+    REQUIRE(b.find(100) == 1000);
+    REQUIRE(a.find(5) == array_type::npos);
+
+    a = b;
+
+    REQUIRE(a.find(5) == 50);
+    REQUIRE(a.page_count() == 2);
+  }
+}
+
+TEST_CASE("FlatHashMap", "[mapping]") {
+  using namespace nete;
+
+  using map_type = FlatHashMap<std::uint32_t>;
+
+  SECTION("insert and erase") {
+    map_type m;
+
+    REQUIRE(m.find(0) == map_type::npos);
+
+    m.insert(0, 10);
+    m.insert(123456789, 20);
+    m.insert(0, 30);
+
+    REQUIRE(m.size() == 2);
+    REQUIRE(m.find(0) == 30);
+    REQUIRE(m.find(123456789) == 20);
+    REQUIRE(m.find(1) == map_type::npos);
+
+    m.erase(0);
+
+    REQUIRE(m.size() == 1);
+    REQUIRE(m.find(0) == map_type::npos);
+    REQUIRE(m.find(123456789) == 20);
+  }
+
+  SECTION("many indices") {
+    map_type m;
+    std::unordered_map<std::size_t, std::uint32_t> expected;
+
+    for (std::uint32_t i = 0; i < 10000; ++i) {
+      std::size_t index = i * 7919;
+      m.insert(index, i);
+      expected[index] = i;
+      if (i % 3 == 0) {
+        std::size_t erased = (i / 2) * 7919;
+        if (expected.count(erased)) {
+          m.erase(erased);
+          expected.erase(erased);
+        }
+      }
+    }
+
+    REQUIRE(m.size() == expected.size());
+    REQUIRE(m.capacity() * 7 / 8 >= m.size());
+
+    for (std::uint32_t i = 0; i < 10000; ++i) {
+      std::size_t index = i * 7919;
+      auto it = expected.find(index);
+      REQUIRE(m.find(index) ==
+              (it != expected.end() ? it->second : map_type::npos));
+    }
+  }
+
+  SECTION("deleted slots are reused") {
+    map_type m;
+
+    for (std::uint32_t i = 0; i < 100000; ++i) {
+      m.insert(i, i);
+      m.erase(i);
+    }
+
+    REQUIRE(m.size() == 0);
+    REQUIRE(m.capacity() == 16);
+  }
+
+  SECTION("component") {
+    Component<Chunks<int>, FlatHashMapMapping> c;
+
+    c.insert(4000000000u, 1);
+    c.insert(17, 2);
+    c.erase(4000000000u);
+
+    REQUIRE(!c.has(4000000000u));
+    REQUIRE(c.at<0>(17) == 2);
+  }
+}
+
+struct TrackedComponentTraits : nete::DefaultComponentTraits {
+  static constexpr bool track_changes = true;
+};
+
+TEST_CASE("Component change detection", "[component]") {
+  using namespace nete;
+
+  using component_type =
+      Component<Chunks<int, float>, PagedSparseArrayMapping<>,
+                DefaultEntityTraits, TrackedComponentTraits>;
+
+  auto changed = [](const component_type &c, component_type::tick_type since) {
+    std::vector<std::uint32_t> entities;
+    for (auto it : c.changed_since(since)) {
+      entities.push_back(c.entity(it));
+    }
+    return entities;
+  };
+
+  SECTION("rows are stamped on insertion and mutable access") {
+    component_type c;
+
+    REQUIRE(c.tick() == 1);
+
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+      c.insert(i, i, 0.f);
+    }
+
+    REQUIRE(changed(c, 0).size() == 1000);
+
+    component_type::tick_type seen = c.advance_tick();
+
+    REQUIRE(seen == 1);
+    REQUIRE(changed(c, seen).empty());
+
+    c.at<0>(700) = 7;
+    c.get<1>(c.find(3)) = 0.5f;
+    c.mark_changed(c.find(900));
+
+    const component_type &const_c = c;
+    REQUIRE(const_c.at<0>(500) == 500);
+
+    std::vector<std::uint32_t> expected{3, 700, 900};
+    REQUIRE(changed(c, seen) == expected);
+    REQUIRE(c.change_tick(c.find(700)) == 2);
+    REQUIRE(c.change_tick(c.find(500)) == 1);
+
+    seen = c.advance_tick();
+
+    REQUIRE(changed(c, seen).empty());
+  }
+
+  SECTION("moved rows keep their ticks") {
+    component_type c;
+
+    for (std::uint32_t i = 0; i < 200; ++i) {
+      c.insert(i, i, 0.f);
+    }
+
+    component_type::tick_type seen = c.advance_tick();
+    c.at<0>(199) = 1;
+    c.erase(5);
+
+    std::vector<std::uint32_t> expected{199};
+    REQUIRE(changed(c, seen) == expected);
+    REQUIRE(c.find(199) == c.begin() + 5);
+
+    c.clear();
+
+    REQUIRE(changed(c, 0).empty());
+
+    // the rows added after `clear` are still newer than the ticks seen before
+    c.insert(7, 7, 0.f);
+
+    expected = {7};
+    REQUIRE(changed(c, seen) == expected);
+  }
+
+  SECTION("untracked components have no tick column") {
+    static_assert(!Component<int>::track_changes, "");
+    static_assert(Component<int>::storage_type::value_types::size == 2, "");
+    static_assert(component_type::storage_type::value_types::size == 4, "");
+  }
+}
@@ -1,8 +1,19 @@
 #include "catch.hpp"
 
 #include <nete/nete.h>
-
+#include <nete/tl/grouped_multivector.h>
+#include <nete/tl/parallel.h>
+#include <nete/tl/segmented_multivector.h>
+#include <nete/tl/small_fast_vector.h>
+#include <nete/tl/static_multivector.h>
+#include <nete/tl/tiled_multivector.h>
+
+#include <functional>
+#include <limits>
+#include <list>
 #include <string>
+#include <system_error>
+#include <thread>
 
 TEST_CASE("multivector construction", "[multivector]") {
   using namespace nete::tl;
@@ -103,7 +114,8 @@ TEST_CASE("multivector construction", "[multivector]") {
 
     REQUIRE(v_prim.size() == size);
     REQUIRE(v_prim.capacity() >= size);
-    REQUIRE(v_storage == v_prim.storage());
+    REQUIRE(static_cast<const void *>(v_storage) ==
+            static_cast<const void *>(v_prim.storage()));
     REQUIRE(string_data == v_prim.at<2>(0).data());
     REQUIRE(int_pointer == v_prim.at<3>(0).get());
   }
@@ -171,7 +183,8 @@ TEST_CASE("multivector assignment", "[multivector]") {
     REQUIRE(v_prim.at<0>(0) == e0);
     REQUIRE(v_prim.at<1>(0) == e1);
     REQUIRE(v_prim.at<2>(0) == e2);
-    REQUIRE(v_storage == v_prim.storage());
+    REQUIRE(static_cast<const void *>(v_storage) ==
+            static_cast<const void *>(v_prim.storage()));
     REQUIRE(string_data == v_prim.at<2>(0).data());
     REQUIRE(int_pointer == v_prim.at<3>(0).get());
   }
@@ -211,7 +224,8 @@ TEST_CASE("multivector resizing", "[multivector]") {
     REQUIRE(v.at<0>(0) == e0);
     REQUIRE(v.at<1>(0) == e1);
     REQUIRE(v.at<2>(0) == e2);
-    REQUIRE(v_storage != v.storage());
+    REQUIRE(static_cast<const void *>(v_storage) !=
+            static_cast<const void *>(v.storage()));
     REQUIRE(vector_data == v.at<2>(0).data());
     REQUIRE(int_pointer == v.at<3>(0).get());
 
@@ -352,6 +366,37 @@ TEST_CASE("multivector resizing", "[multivector]") {
     REQUIRE(v.at<2>(size) == std::string{});
   }
 
+  SECTION("emplace_back with arguments") {
+    multivector<types<char, std::string, std::vector<int>>> v;
+
+    v.emplace_back('a', "hello", 3);
+    v.emplace_back('b', v.at<1>(0), v.at<2>(0));
+
+    REQUIRE(v.size() == 2);
+
+    for (int i = 0; i < 2; ++i) {
+      REQUIRE(v.at<0>(i) == 'a' + i);
+      REQUIRE(v.at<1>(i) == "hello");
+      REQUIRE(v.at<2>(i) == std::vector<int>(3));
+    }
+  }
+
+  SECTION("push_back of rvalues") {
+    multivector<types<std::unique_ptr<int>, std::vector<int>>> v;
+
+    std::vector<int> e1{1, 2, 3};
+    const int *e1_data = e1.data();
+
+    v.push_back(std::unique_ptr<int>{new int{8}}, std::move(e1));
+    v.push_back(nullptr, {});
+
+    REQUIRE(v.size() == 2);
+    REQUIRE(*v.at<0>(0) == 8);
+    REQUIRE(v.at<1>(0).data() == e1_data);
+    REQUIRE(v.at<0>(1) == nullptr);
+    REQUIRE(v.at<1>(1).empty());
+  }
+
   SECTION("pop_back") {
     int size = 4;
     char e0 = 'a';
@@ -369,7 +414,8 @@ TEST_CASE("multivector resizing", "[multivector]") {
 
     REQUIRE(v.size() == size - 1);
     REQUIRE(v.capacity() >= size);
-    REQUIRE(v_storage == v.storage());
+    REQUIRE(static_cast<const void *>(v_storage) ==
+            static_cast<const void *>(v.storage()));
 
     for (int i = 0; i < size - 1; ++i) {
       REQUIRE(v.at<0>(i) == e0);
@@ -396,6 +442,319 @@ TEST_CASE("multivector resizing", "[multivector]") {
   }
 }
 
+struct slow_growth_multivector_traits {
+  using allocator_type = std::allocator<char>;
+  using size_type = size_t;
+  using growth_policy = nete::tl::geometric_growth<3, 2, 2>;
+  static constexpr bool disable_initialization = false;
+};
+
+TEST_CASE("multivector growth", "[multivector]") {
+  using namespace nete::tl;
+
+  SECTION("push_back") {
+    int size = 1000;
+
+    multivector<types<char, uint16_t, std::string>> v;
+
+    int reallocations = 0;
+    const char *v_storage = v.storage();
+
+    for (int i = 0; i < size; ++i) {
+      v.push_back('a' + i % 26, i, std::to_string(i));
+      if (v.storage() != v_storage) {
+        v_storage = v.storage();
+        ++reallocations;
+      }
+    }
+
+    REQUIRE(v.size() == size);
+    REQUIRE(v.capacity() >= size);
+    REQUIRE(reallocations <= 10);
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at<0>(i) == 'a' + i % 26);
+      REQUIRE(v.at<1>(i) == i);
+      REQUIRE(v.at<2>(i) == std::to_string(i));
+    }
+  }
+
+  SECTION("push_back of own elements") {
+    multivector<types<char, std::string>> v(1, 'a', "hello");
+
+    REQUIRE(v.capacity() == 1);
+
+    v.push_back(v.at<0>(0), v.at<1>(0));
+
+    REQUIRE(v.size() == 2);
+    REQUIRE(v.at<0>(1) == 'a');
+    REQUIRE(v.at<1>(1) == "hello");
+  }
+
+  SECTION("emplace_back") {
+    int size = 100;
+
+    multivector<types<char, std::string>> v;
+
+    for (int i = 0; i < size; ++i) {
+      v.emplace_back();
+      v.at<1>(i) = std::to_string(i);
+    }
+
+    REQUIRE(v.size() == size);
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at<0>(i) == char{});
+      REQUIRE(v.at<1>(i) == std::to_string(i));
+    }
+  }
+
+  SECTION("shrink_to_fit") {
+    multivector<types<char, std::string>> v(8, 'a', "hello");
+
+    v.reserve(32);
+    v.pop_back();
+
+    REQUIRE(v.size() == 7);
+    REQUIRE(v.capacity() >= 32);
+
+    v.shrink_to_fit();
+
+    REQUIRE(v.size() == 7);
+    REQUIRE(v.capacity() == 7);
+
+    for (int i = 0; i < 7; ++i) {
+      REQUIRE(v.at<0>(i) == 'a');
+      REQUIRE(v.at<1>(i) == "hello");
+    }
+
+    v.clear();
+
+    REQUIRE(v.empty());
+    REQUIRE(v.capacity() == 7);
+  }
+
+  SECTION("append") {
+    int size = 100;
+
+    std::vector<char> chars(size);
+    std::vector<uint32_t> numbers(size);
+    std::vector<std::string> strings(size);
+
+    for (int i = 0; i < size; ++i) {
+      chars[i] = 'a' + i % 26;
+      numbers[i] = i;
+      strings[i] = std::to_string(i);
+    }
+
+    multivector<types<char, uint32_t, std::string>> v(1, 'z', 0, "zero");
+
+    v.append(size, chars.data(), numbers.data(), strings.data());
+
+    REQUIRE(v.size() == size + 1);
+    REQUIRE(v.at<2>(0) == "zero");
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at<0>(i + 1) == 'a' + i % 26);
+      REQUIRE(v.at<1>(i + 1) == i);
+      REQUIRE(v.at<2>(i + 1) == std::to_string(i));
+    }
+  }
+
+  SECTION("append from iterators") {
+    std::list<uint32_t> numbers{1, 2, 3};
+    std::vector<std::string> strings{"one", "two", "three"};
+
+    multivector<types<uint32_t, std::string>> v;
+
+    v.append(3, numbers.begin(), strings.cbegin());
+    v.append(2, numbers.rbegin(), strings.crbegin());
+
+    REQUIRE(v.size() == 5);
+
+    REQUIRE(v.at<0>(2) == 3);
+    REQUIRE(v.at<1>(2) == "three");
+    REQUIRE(v.at<0>(4) == 2);
+    REQUIRE(v.at<1>(4) == "two");
+  }
+
+  SECTION("growth policy") {
+    multivector<types<char, uint32_t>, slow_growth_multivector_traits> v;
+
+    v.push_back('a', 1);
+
+    REQUIRE(v.capacity() == 2);
+
+    v.push_back('b', 2);
+    v.push_back('c', 3);
+
+    REQUIRE(v.capacity() == 3);
+
+    v.push_back('d', 4);
+
+    REQUIRE(v.capacity() == 4);
+  }
+}
+
+struct realloc_multivector_traits {
+  using allocator_type = nete::tl::malloc_allocator<char>;
+  using size_type = size_t;
+  static constexpr bool disable_initialization = false;
+};
+
+TEST_CASE("multivector in-place reallocation", "[multivector]") {
+  using namespace nete::tl;
+
+  using multivector_type =
+      multivector<types<char, uint16_t, double>, realloc_multivector_traits>;
+
+  static_assert(std::is_same<multivector_type::relocation_t,
+                             in_place_relocation_t>::value,
+                "");
+
+  SECTION("push_back") {
+    int size = 1000;
+
+    multivector_type v;
+
+    for (int i = 0; i < size; ++i) {
+      v.push_back('a' + i % 26, i, i / 2.0);
+    }
+
+    REQUIRE(v.size() == size);
+    REQUIRE(v.capacity() >= size);
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at<0>(i) == 'a' + i % 26);
+      REQUIRE(v.at<1>(i) == i);
+      REQUIRE(v.at<2>(i) == i / 2.0);
+    }
+  }
+
+  SECTION("push_back of own elements") {
+    multivector_type v(1, 'a', 16, 0.5);
+
+    REQUIRE(v.capacity() == 1);
+
+    v.push_back(v.at<0>(0), v.at<1>(0), v.at<2>(0));
+
+    REQUIRE(v.size() == 2);
+    REQUIRE(v.at<0>(1) == 'a');
+    REQUIRE(v.at<1>(1) == 16);
+    REQUIRE(v.at<2>(1) == 0.5);
+  }
+
+  SECTION("reserve and shrink_to_fit") {
+    int size = 5;
+
+    multivector_type v(size, 'a', 16, 0.5);
+
+    v.reserve(1000);
+
+    REQUIRE(v.capacity() >= 1000);
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at<0>(i) == 'a');
+      REQUIRE(v.at<1>(i) == 16);
+      REQUIRE(v.at<2>(i) == 0.5);
+    }
+
+    v.shrink_to_fit();
+
+    REQUIRE(v.capacity() == size);
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at<0>(i) == 'a');
+      REQUIRE(v.at<1>(i) == 16);
+      REQUIRE(v.at<2>(i) == 0.5);
+    }
+  }
+}
+
+struct move_counter {
+  static int moves;
+
+  int value = 0;
+
+  move_counter() = default;
+  move_counter(int value) : value(value) {}
+  move_counter(const move_counter &) = default;
+  move_counter(move_counter &&x) : value(x.value) { ++moves; }
+  move_counter &operator=(const move_counter &) = default;
+  move_counter &operator=(move_counter &&) = default;
+};
+
+int move_counter::moves = 0;
+
+struct relocatable_move_counter : move_counter {
+  using move_counter::move_counter;
+};
+
+namespace nete {
+namespace tl {
+template <>
+struct is_trivially_relocatable<relocatable_move_counter> : std::true_type {};
+} // namespace tl
+} // namespace nete
+
+TEST_CASE("multivector relocation", "[multivector]") {
+  using namespace nete::tl;
+
+  SECTION("only live rows are moved") {
+    multivector<types<move_counter, int>> v;
+
+    v.reserve(8);
+    v.push_back(1, 1);
+    v.push_back(2, 2);
+
+    move_counter::moves = 0;
+    v.reserve(64);
+
+    REQUIRE(move_counter::moves == 2);
+    REQUIRE(v.at<0>(1).value == 2);
+  }
+
+  SECTION("trivially relocatable columns are not moved") {
+    multivector<types<relocatable_move_counter, std::unique_ptr<int>>> v;
+
+    for (int i = 0; i < 10; ++i) {
+      v.push_back(i, std::unique_ptr<int>{new int{i}});
+    }
+
+    move_counter::moves = 0;
+    v.reserve(100);
+
+    REQUIRE(move_counter::moves == 0);
+
+    for (int i = 0; i < 10; ++i) {
+      REQUIRE(v.at<0>(i).value == i);
+      REQUIRE(*v.at<1>(i) == i);
+    }
+  }
+
+  SECTION("in-place reallocation of relocatable columns") {
+    using multivector_type = multivector<types<std::unique_ptr<int>, int>,
+                                         realloc_multivector_traits>;
+
+    static_assert(std::is_same<multivector_type::relocation_t,
+                               in_place_relocation_t>::value,
+                  "");
+
+    multivector_type v;
+
+    for (int i = 0; i < 100; ++i) {
+      v.emplace_back(std::unique_ptr<int>{new int{i}}, i);
+    }
+
+    v.shrink_to_fit();
+
+    for (int i = 0; i < 100; ++i) {
+      REQUIRE(*v.at<0>(i) == i);
+      REQUIRE(v.at<1>(i) == i);
+    }
+  }
+}
+
 TEST_CASE("multivector iteration", "[multivector]") {
   using namespace nete::tl;
 
@@ -544,6 +903,152 @@ TEST_CASE("multivector iteration", "[multivector]") {
   }
 }
 
+TEST_CASE("multivector zip iteration", "[multivector]") {
+  using namespace nete::tl;
+
+  int size = 4;
+
+  multivector<types<char, uint16_t, std::string>> v(size);
+
+  for (int i = 0; i < size; ++i) {
+    v.at<0>(i) = 'a' + i;
+    v.at<1>(i) = 100 * i;
+    v.at<2>(i) = std::string(i, 'x');
+  }
+
+  SECTION("range-based for") {
+    int i = 0;
+    for (auto row : v.zip<2, 0>()) {
+      REQUIRE(std::get<0>(row) == std::string(i, 'x'));
+      REQUIRE(std::get<1>(row) == 'a' + i);
+      std::get<0>(row) += "y";
+      ++i;
+    }
+
+    REQUIRE(i == size);
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at<2>(i) == std::string(i, 'x') + "y");
+    }
+  }
+
+  SECTION("all columns") {
+    const auto &v_const = v;
+
+    int i = 0;
+    for (auto row : v_const.zip()) {
+      REQUIRE(std::get<0>(row) == 'a' + i);
+      REQUIRE(std::get<1>(row) == 100 * i);
+      REQUIRE(std::get<2>(row) == std::string(i, 'x'));
+      ++i;
+    }
+
+    REQUIRE(i == size);
+  }
+
+  SECTION("standard algorithms") {
+    auto range = v.zip<0, 1>();
+
+    REQUIRE(range.size() == size);
+    REQUIRE(std::distance(range.begin(), range.end()) == size);
+
+    auto it = std::find_if(range.begin(), range.end(),
+                           [](std::tuple<char &, uint16_t &> row) {
+                             return std::get<1>(row) == 200;
+                           });
+
+    REQUIRE(it - range.begin() == 2);
+    REQUIRE(std::get<0>(*it) == 'c');
+    REQUIRE(std::get<0>(range.begin()[3]) == 'd');
+
+    std::for_each(range.begin(), range.end(),
+                  [](std::tuple<char &, uint16_t &> row) {
+                    std::get<1>(row) += 1;
+                  });
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at<1>(i) == 100 * i + 1);
+    }
+  }
+
+  SECTION("mutating algorithms") {
+    auto range = v.zip<2, 1>();
+
+    std::reverse(range.begin(), range.end());
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at<0>(i) == 'a' + i);
+      REQUIRE(v.at<1>(i) == 100 * (size - 1 - i));
+      REQUIRE(v.at<2>(i) == std::string(size - 1 - i, 'x'));
+    }
+
+    std::sort(range.begin(), range.end());
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at<0>(i) == 'a' + i);
+      REQUIRE(v.at<1>(i) == 100 * i);
+      REQUIRE(v.at<2>(i) == std::string(i, 'x'));
+    }
+
+    std::iter_swap(range.begin(), range.begin() + 3);
+
+    REQUIRE(v.at<1>(0) == 300);
+    REQUIRE(v.at<2>(0) == "xxx");
+    REQUIRE(v.at<1>(3) == 0);
+    REQUIRE(v.at<2>(3) == "");
+  }
+}
+
+TEST_CASE("multivector views", "[multivector]") {
+  using namespace nete::tl;
+
+  int size = 100;
+
+  multivector<types<char, float, std::string, double>> v;
+
+  for (int i = 0; i < size; ++i) {
+    v.push_back('a', i, "hello", 2 * i);
+  }
+
+  SECTION("element access") {
+    auto view = v.view<3, 1>();
+
+    REQUIRE(view.size() == size);
+    REQUIRE(view.data<0>() == v.data<3>());
+    REQUIRE(view.data<1>() == v.data<1>());
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(view.at<0>(i) == 2 * i);
+      REQUIRE(view.at<1>(i) == i);
+    }
+  }
+
+  SECTION("for_each") {
+    v.view<1, 3>().for_each([](float &x, double &y) { y += x; });
+
+    double sum = 0;
+    const auto &v_const = v;
+    v_const.view<3>().for_each([&sum](const double &y) { sum += y; });
+
+    REQUIRE(sum == 3 * (size - 1) * size / 2);
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at<3>(i) == 3 * i);
+    }
+  }
+
+  SECTION("iteration") {
+    int i = 0;
+    for (auto row : v.view<0, 2>()) {
+      REQUIRE(std::get<0>(row) == 'a');
+      REQUIRE(std::get<1>(row) == "hello");
+      ++i;
+    }
+
+    REQUIRE(i == size);
+  }
+}
+
 TEST_CASE("multivector swapping", "[multivector]") {
   using namespace nete::tl;
 
@@ -588,36 +1093,382 @@ TEST_CASE("multivector swapping", "[multivector]") {
   REQUIRE(v.at<2>(2) == 0xBBBBBBBB);
 }
 
-TEST_CASE("multivector consistency", "[multivector]") {
+TEST_CASE("multivector unordered erasure", "[multivector]") {
   using namespace nete::tl;
 
-  int size = 3;
+  int size = 5;
 
-  multivector<types<char, uint16_t>> v(size);
+  multivector<types<char, std::string>> v;
 
-  v.at<0>(0) = 'x';
-  v.at<1>(0) = 100;
-  v.at<0>(1) = 'y';
-  v.at<1>(1) = 200;
-  v.at<0>(2) = 'z';
-  v.at<1>(2) = 300;
+  for (int i = 0; i < size; ++i) {
+    v.push_back('a' + i, std::string(i, 'x'));
+  }
 
-  REQUIRE(v.get<0>(v.begin() + 0) == 'x');
-  REQUIRE(v.get<1>(v.begin() + 0) == 100);
-  REQUIRE(v.get<0>(v.begin() + 1) == 'y');
-  REQUIRE(v.get<1>(v.begin() + 1) == 200);
-  REQUIRE(v.get<0>(v.begin() + 2) == 'z');
-  REQUIRE(v.get<1>(v.begin() + 2) == 300);
+  SECTION("single row") {
+    REQUIRE(v.erase_unordered(v.begin() + 1) == 4);
 
-  REQUIRE(v.data<0>()[0] == 'x');
-  REQUIRE(v.data<1>()[0] == 100);
-  REQUIRE(v.data<0>()[1] == 'y');
-  REQUIRE(v.data<1>()[1] == 200);
-  REQUIRE(v.data<0>()[2] == 'z');
-  REQUIRE(v.data<1>()[2] == 300);
-}
+    REQUIRE(v.size() == 4);
+    REQUIRE(v.at<0>(0) == 'a');
+    REQUIRE(v.at<0>(1) == 'e');
+    REQUIRE(v.at<1>(1) == "xxxx");
+    REQUIRE(v.at<0>(2) == 'c');
+    REQUIRE(v.at<0>(3) == 'd');
 
-TEST_CASE("multivector alignment", "[multivector]") {
+    REQUIRE(v.erase_unordered(v.begin() + 3) == 3);
+
+    REQUIRE(v.size() == 3);
+    REQUIRE(v.at<0>(0) == 'a');
+    REQUIRE(v.at<0>(1) == 'e');
+    REQUIRE(v.at<0>(2) == 'c');
+    REQUIRE(v.at<1>(2) == "xx");
+  }
+
+  SECTION("many rows") {
+    std::vector<int> indices{0, 2, 3};
+    std::vector<std::pair<int, int>> moves;
+
+    v.erase_unordered(indices.begin(), indices.end(),
+                      [&moves](std::size_t from, std::size_t to) {
+                        moves.emplace_back(from, to);
+                      });
+
+    REQUIRE(v.size() == 2);
+    REQUIRE(v.at<0>(0) == 'e');
+    REQUIRE(v.at<1>(0) == "xxxx");
+    REQUIRE(v.at<0>(1) == 'b');
+    REQUIRE(v.at<1>(1) == "x");
+
+    REQUIRE(moves.size() == 1);
+    REQUIRE(moves[0] == std::make_pair(4, 0));
+  }
+
+  SECTION("rows are moved once") {
+    for (int i = size; i < 10; ++i) {
+      v.push_back('a' + i, std::string(i, 'x'));
+    }
+
+    std::vector<std::size_t> indices{1, 2, 5, 8, 9};
+    std::vector<std::pair<int, int>> moves;
+
+    v.erase_unordered(indices.begin(), indices.end(),
+                      [&moves](std::size_t from, std::size_t to) {
+                        moves.emplace_back(from, to);
+                      });
+
+    REQUIRE(v.size() == 5);
+    REQUIRE(v.at<0>(0) == 'a');
+    REQUIRE(v.at<0>(1) == 'h');
+    REQUIRE(v.at<1>(1) == "xxxxxxx");
+    REQUIRE(v.at<0>(2) == 'g');
+    REQUIRE(v.at<0>(3) == 'd');
+    REQUIRE(v.at<0>(4) == 'e');
+
+    REQUIRE(moves.size() == 2);
+    REQUIRE(moves[0] == std::make_pair(7, 1));
+    REQUIRE(moves[1] == std::make_pair(6, 2));
+  }
+
+  SECTION("iterator range") {
+    v.erase_unordered(v.begin() + 3, v.end());
+
+    REQUIRE(v.size() == 3);
+    REQUIRE(v.at<0>(0) == 'a');
+    REQUIRE(v.at<0>(1) == 'b');
+    REQUIRE(v.at<0>(2) == 'c');
+  }
+}
+
+TEST_CASE("multivector compaction", "[multivector]") {
+  using namespace nete::tl;
+
+  int size = 8;
+
+  multivector<types<char, int, std::string>> v;
+
+  for (int i = 0; i < size; ++i) {
+    v.push_back('a' + i, i, std::string(i, 'x'));
+  }
+
+  SECTION("remove_if") {
+    std::vector<std::pair<std::size_t, std::size_t>> remaps;
+    int calls = 0;
+
+    auto removed = v.remove_if<1>(
+        [&calls](int i) {
+          ++calls;
+          return i == 0 || i == 3 || i == 4 || i == 7;
+        },
+        [&remaps](std::size_t from, std::size_t to) {
+          remaps.emplace_back(from, to);
+        });
+
+    REQUIRE(calls == size);
+    REQUIRE(removed == 4);
+    REQUIRE(v.size() == 4);
+
+    int kept[] = {1, 2, 5, 6};
+    for (int i = 0; i < 4; ++i) {
+      REQUIRE(v.at<0>(i) == 'a' + kept[i]);
+      REQUIRE(v.at<1>(i) == kept[i]);
+      REQUIRE(v.at<2>(i) == std::string(kept[i], 'x'));
+    }
+
+    auto npos = decltype(v)::npos;
+    std::vector<std::pair<std::size_t, std::size_t>> expected_remaps{
+        {0, npos}, {1, 0}, {2, 1}, {3, npos},
+        {4, npos}, {5, 2}, {6, 3}, {7, npos}};
+
+    REQUIRE(remaps == expected_remaps);
+  }
+
+  SECTION("predicate over many columns") {
+    auto removed = v.remove_if<0, 2>([](char c, const std::string &s) {
+      return c == 'c' || s.size() == 5;
+    });
+
+    REQUIRE(removed == 2);
+    REQUIRE(v.size() == 6);
+
+    int kept[] = {0, 1, 3, 4, 6, 7};
+    for (int i = 0; i < 6; ++i) {
+      REQUIRE(v.at<1>(i) == kept[i]);
+      REQUIRE(v.at<2>(i) == std::string(kept[i], 'x'));
+    }
+  }
+
+  SECTION("all columns") {
+    REQUIRE(v.remove_if([](char, int, const std::string &) { return true; }) ==
+            size);
+    REQUIRE(v.empty());
+  }
+
+  SECTION("nothing removed") {
+    REQUIRE(v.remove_if<1>([](int) { return false; }) == 0);
+    REQUIRE(v.size() == size);
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at<2>(i) == std::string(i, 'x'));
+    }
+  }
+}
+
+TEST_CASE("multivector sorting", "[multivector]") {
+  using namespace nete::tl;
+
+  multivector<types<int, std::string, double>> v;
+
+  v.push_back(3, "c", 0.3);
+  v.push_back(-1, "a", -0.1);
+  v.push_back(2, "b", 0.2);
+  v.push_back(-1, "z", -0.2);
+  v.push_back(0, "y", 0.0);
+
+  SECTION("integral key") {
+    v.sort_by<0>();
+
+    int keys[] = {-1, -1, 0, 2, 3};
+    std::string strings[] = {"a", "z", "y", "b", "c"};
+    double doubles[] = {-0.1, -0.2, 0.0, 0.2, 0.3};
+
+    for (int i = 0; i < 5; ++i) {
+      REQUIRE(v.at<0>(i) == keys[i]);
+      REQUIRE(v.at<1>(i) == strings[i]);
+      REQUIRE(v.at<2>(i) == doubles[i]);
+    }
+  }
+
+  SECTION("comparison") {
+    v.sort_by<1>();
+
+    int keys[] = {-1, 2, 3, 0, -1};
+    std::string strings[] = {"a", "b", "c", "y", "z"};
+
+    for (int i = 0; i < 5; ++i) {
+      REQUIRE(v.at<0>(i) == keys[i]);
+      REQUIRE(v.at<1>(i) == strings[i]);
+    }
+
+    v.sort_by<2>(std::greater<double>{});
+
+    double doubles[] = {0.3, 0.2, 0.0, -0.1, -0.2};
+
+    for (int i = 0; i < 5; ++i) {
+      REQUIRE(v.at<2>(i) == doubles[i]);
+    }
+  }
+
+  SECTION("many rows") {
+    int size = 10000;
+
+    multivector<types<int64_t, uint8_t, int>> w;
+    std::vector<std::pair<int64_t, int>> expected;
+
+    uint64_t seed = 12345;
+    for (int i = 0; i < size; ++i) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      int64_t key = static_cast<int64_t>(seed) >> (seed % 48);
+      w.push_back(key, static_cast<uint8_t>(i), i);
+      expected.emplace_back(key, i);
+    }
+
+    w.sort_by<0>();
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const std::pair<int64_t, int> &a,
+                        const std::pair<int64_t, int> &b) {
+                       return a.first < b.first;
+                     });
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(w.at<0>(i) == expected[i].first);
+      REQUIRE(w.at<1>(i) == static_cast<uint8_t>(expected[i].second));
+      REQUIRE(w.at<2>(i) == expected[i].second);
+    }
+  }
+}
+
+TEST_CASE("multivector parallel sorting", "[multivector]") {
+  using namespace nete::tl;
+
+  SECTION("floating point key") {
+    multivector<types<double, int>> v;
+
+    double keys[] = {0.5, -2.0, 1e10, -0.25, 0.0, -1e-10, 3.0};
+    for (int i = 0; i < 7; ++i) {
+      v.push_back(keys[i], i);
+    }
+
+    v.sort_by<0>();
+
+    int order[] = {1, 3, 5, 4, 0, 6, 2};
+    for (int i = 0; i < 7; ++i) {
+      REQUIRE(v.at<0>(i) == keys[order[i]]);
+      REQUIRE(v.at<1>(i) == order[i]);
+    }
+  }
+
+  SECTION("signed zeros and NaNs") {
+    multivector<types<float, int>> v;
+
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    float keys[] = {0.f, nan, -0.f, -nan, 1.f, -1.f, 0.f};
+    for (int i = 0; i < 7; ++i) {
+      v.push_back(keys[i], i);
+    }
+
+    v.parallel_sort_by<0>(2);
+
+    int order[] = {5, 0, 2, 6, 4, 1, 3};
+    for (int i = 0; i < 7; ++i) {
+      REQUIRE(v.at<1>(i) == order[i]);
+    }
+  }
+
+  SECTION("many threads") {
+    int size = 100000;
+
+    multivector<types<std::string, int64_t, float, int>> v;
+    std::vector<std::pair<int64_t, int>> expected;
+
+    uint64_t seed = 12345;
+    for (int i = 0; i < size; ++i) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      int64_t key = static_cast<int64_t>(seed) >> (seed % 56);
+      v.push_back(std::to_string(i), key, static_cast<float>(i), i);
+      expected.emplace_back(key, i);
+    }
+
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const std::pair<int64_t, int> &a,
+                        const std::pair<int64_t, int> &b) {
+                       return a.first < b.first;
+                     });
+
+    v.parallel_sort_by<1>(4);
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at<0>(i) == std::to_string(expected[i].second));
+      REQUIRE(v.at<1>(i) == expected[i].first);
+      REQUIRE(v.at<2>(i) == static_cast<float>(expected[i].second));
+      REQUIRE(v.at<3>(i) == expected[i].second);
+    }
+
+    v.parallel_sort_by<2>(3);
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at<0>(i) == std::to_string(i));
+      REQUIRE(v.at<3>(i) == i);
+    }
+  }
+}
+
+TEST_CASE("parallel_for_chunks", "[parallel]") {
+  using namespace nete::tl;
+
+  std::vector<int> visits(100);
+  auto visit = [&](std::size_t, std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; ++i) {
+      ++visits[i];
+    }
+  };
+
+  SECTION("all threads started") {
+    parallel_for_chunks(visits.size(), 4, visit);
+
+    for (int count : visits) {
+      REQUIRE(count == 1);
+    }
+  }
+
+  SECTION("threads that fail to start") {
+    int started = 0;
+    auto start_thread = [&started](std::function<void()> f) {
+      if (started == 1) {
+        throw std::system_error(
+            std::make_error_code(std::errc::resource_unavailable_try_again));
+      }
+      ++started;
+      return std::thread(std::move(f));
+    };
+
+    parallel_for_chunks(visits.size(), 4, visit, start_thread);
+
+    REQUIRE(started == 1);
+    for (int count : visits) {
+      REQUIRE(count == 1);
+    }
+  }
+}
+
+TEST_CASE("multivector consistency", "[multivector]") {
+  using namespace nete::tl;
+
+  int size = 3;
+
+  multivector<types<char, uint16_t>> v(size);
+
+  v.at<0>(0) = 'x';
+  v.at<1>(0) = 100;
+  v.at<0>(1) = 'y';
+  v.at<1>(1) = 200;
+  v.at<0>(2) = 'z';
+  v.at<1>(2) = 300;
+
+  REQUIRE(v.get<0>(v.begin() + 0) == 'x');
+  REQUIRE(v.get<1>(v.begin() + 0) == 100);
+  REQUIRE(v.get<0>(v.begin() + 1) == 'y');
+  REQUIRE(v.get<1>(v.begin() + 1) == 200);
+  REQUIRE(v.get<0>(v.begin() + 2) == 'z');
+  REQUIRE(v.get<1>(v.begin() + 2) == 300);
+
+  REQUIRE(v.data<0>()[0] == 'x');
+  REQUIRE(v.data<1>()[0] == 100);
+  REQUIRE(v.data<0>()[1] == 'y');
+  REQUIRE(v.data<1>()[1] == 200);
+  REQUIRE(v.data<0>()[2] == 'z');
+  REQUIRE(v.data<1>()[2] == 300);
+}
+
+TEST_CASE("multivector alignment", "[multivector]") {
   using namespace nete::tl;
 
   CHECK(sizeof(int) == 4);
@@ -637,9 +1488,125 @@ TEST_CASE("multivector alignment", "[multivector]") {
     void *d1_ = d1;
     void *d2_ = d2;
 
-    REQUIRE(reinterpret_cast<char *>(d0_) - storage == 0);
-    REQUIRE(reinterpret_cast<char *>(d1_) - storage == 8);
-    REQUIRE(reinterpret_cast<char *>(d2_) - storage == 32);
+    // the columns are stored by descending alignment
+    REQUIRE(reinterpret_cast<char *>(d0_) - storage == 60);
+    REQUIRE(reinterpret_cast<char *>(d1_) - storage == 40);
+    REQUIRE(reinterpret_cast<char *>(d2_) - storage == 0);
+  }
+}
+
+TEST_CASE("multivector column order", "[multivector]") {
+  using namespace nete::tl;
+
+  using multivector_type = multivector<types<char, double, short, char>>;
+
+  static_assert(multivector_type::storage_size(0) == 0, "");
+  static_assert(multivector_type::storage_size(3) ==
+                    3 * sizeof(double) + 3 * sizeof(short) + 3 + 3,
+                "");
+
+  auto offsets = calculate_multivector_offsets<char, double, short, char>(3);
+  REQUIRE(offsets[1] == 0);
+  REQUIRE(offsets[2] == 3 * sizeof(double));
+  REQUIRE(offsets[0] == 3 * sizeof(double) + 3 * sizeof(short));
+  REQUIRE(offsets[3] == offsets[0] + 3);
+
+  multivector_type v;
+  for (int i = 0; i < 100; ++i) {
+    v.push_back('a' + i % 26, i * 0.5, i, 'z');
+  }
+  REQUIRE(static_cast<const void *>(v.data<1>()) ==
+          static_cast<const void *>(v.storage()));
+  for (int i = 0; i < 100; ++i) {
+    REQUIRE(v.at<0>(i) == 'a' + i % 26);
+    REQUIRE(v.at<1>(i) == i * 0.5);
+    REQUIRE(v.at<2>(i) == i);
+    REQUIRE(v.at<3>(i) == 'z');
+  }
+}
+
+template <class Allocator> struct cache_line_multivector_traits {
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  static constexpr bool disable_initialization = false;
+  static constexpr std::size_t column_alignment = 64;
+};
+
+template <class Multivector>
+bool columns_are_aligned(Multivector &v, std::size_t alignment) {
+  std::uintptr_t d0 = reinterpret_cast<std::uintptr_t>(v.template data<0>());
+  std::uintptr_t d1 = reinterpret_cast<std::uintptr_t>(v.template data<1>());
+  std::uintptr_t d2 = reinterpret_cast<std::uintptr_t>(v.template data<2>());
+  return d0 % alignment == 0 && d1 % alignment == 0 && d2 % alignment == 0;
+}
+
+TEST_CASE("multivector column alignment", "[multivector]") {
+  using namespace nete::tl;
+
+  SECTION("offsets") {
+    auto offsets = calculate_multivector_offsets<char, int, double>(5, 64);
+
+    REQUIRE(offsets[0] == 128);
+    REQUIRE(offsets[1] == 64);
+    REQUIRE(offsets[2] == 0);
+  }
+
+  SECTION("moving reallocation") {
+    multivector<types<char, int, double>,
+                cache_line_multivector_traits<std::allocator<char>>>
+        v(3, 'a', 123, 456.0);
+
+    REQUIRE(columns_are_aligned(v, 64));
+    REQUIRE(static_cast<const void *>(v.data<2>()) ==
+            static_cast<const void *>(v.storage()));
+
+    for (int i = 0; i < 100; ++i) {
+      v.push_back('b', i, i / 2.0);
+      REQUIRE(columns_are_aligned(v, 64));
+    }
+
+    for (int i = 0; i < 3; ++i) {
+      REQUIRE(v.at<0>(i) == 'a');
+      REQUIRE(v.at<1>(i) == 123);
+      REQUIRE(v.at<2>(i) == 456.0);
+    }
+
+    for (int i = 0; i < 100; ++i) {
+      REQUIRE(v.at<0>(i + 3) == 'b');
+      REQUIRE(v.at<1>(i + 3) == i);
+      REQUIRE(v.at<2>(i + 3) == i / 2.0);
+    }
+  }
+
+  SECTION("in-place reallocation") {
+    multivector<types<char, int, double>,
+                cache_line_multivector_traits<malloc_allocator<char>>>
+        v(3, 'a', 123, 456.0);
+
+    REQUIRE(columns_are_aligned(v, 64));
+
+    for (int i = 0; i < 1000; ++i) {
+      v.push_back('b', i, i / 2.0);
+      REQUIRE(columns_are_aligned(v, 64));
+    }
+
+    v.resize(50);
+    v.shrink_to_fit();
+
+    REQUIRE(v.capacity() == 50);
+    REQUIRE(columns_are_aligned(v, 64));
+
+    for (int i = 0; i < 3; ++i) {
+      REQUIRE(v.at<0>(i) == 'a');
+      REQUIRE(v.at<1>(i) == 123);
+      REQUIRE(v.at<2>(i) == 456.0);
+    }
+
+    for (int i = 0; i < 47; ++i) {
+      REQUIRE(v.at<0>(i + 3) == 'b');
+      REQUIRE(v.at<1>(i + 3) == i);
+      REQUIRE(v.at<2>(i + 3) == i / 2.0);
+    }
   }
 }
 
@@ -733,3 +1700,656 @@ TEST_CASE("multivector initialization", "[multivector]") {
     }
   }
 }
+
+TEST_CASE("multivector column groups", "[multivector]") {
+  using namespace nete::tl;
+
+  using multivector_type = multivector<
+      groups<types<int, float>,
+             group<types<std::string, char>, slow_growth_multivector_traits>>>;
+
+  SECTION("separate storage") {
+    multivector_type v;
+    for (int i = 0; i < 100; ++i) {
+      v.push_back(i, i * 0.5f, std::to_string(i), 'a' + i % 26);
+    }
+    v.push_back(v.at<0>(3), v.at<1>(3), v.at<2>(3), v.at<3>(3));
+
+    REQUIRE(v.size() == 101);
+    REQUIRE(v.group<0>().size() == 101);
+    REQUIRE(v.group<1>().size() == 101);
+    REQUIRE(v.capacity() == std::min(v.group<0>().capacity(),
+                                     v.group<1>().capacity()));
+    REQUIRE(v.data<0>() == v.group<0>().data<0>());
+    REQUIRE(v.data<2>() == v.group<1>().data<0>());
+    REQUIRE(v.at<2>(100) == "3");
+    for (int i = 0; i < 100; ++i) {
+      REQUIRE(v.at<0>(i) == i);
+      REQUIRE(v.at<1>(i) == i * 0.5f);
+      REQUIRE(v.at<2>(i) == std::to_string(i));
+      REQUIRE(v.at<3>(i) == 'a' + i % 26);
+    }
+
+    const std::string *cold = v.data<2>();
+    v.group<0>().reserve(1000);
+    REQUIRE(cold == v.data<2>());
+  }
+
+  SECTION("growth policies") {
+    multivector_type v;
+    v.push_back(0, 0.0f, "", 'a');
+
+    REQUIRE(v.group<0>().capacity() == 8);
+    REQUIRE(v.group<1>().capacity() == 2);
+    REQUIRE(v.capacity() == 2);
+  }
+
+  SECTION("zip and erasure") {
+    multivector_type v(10, 1, 2.0f, "x", 'y');
+    int i = 0;
+    for (std::tuple<int &, std::string &> row : v.zip<0, 2>()) {
+      std::get<0>(row) = i;
+      std::get<1>(row) = std::to_string(i);
+      ++i;
+    }
+
+    REQUIRE(v.erase_unordered(2) == 9);
+    v.swap(0, 1);
+    v.pop_back();
+
+    REQUIRE(v.size() == 8);
+    REQUIRE(v.at<0>(0) == 1);
+    REQUIRE(v.at<2>(0) == "1");
+    REQUIRE(v.at<0>(1) == 0);
+    REQUIRE(v.at<2>(1) == "0");
+    REQUIRE(v.at<0>(2) == 9);
+    REQUIRE(v.at<2>(2) == "9");
+    REQUIRE(v.at<3>(2) == 'y');
+
+    v.resize(12, v.at<0>(2), 0.5f, v.at<2>(2), 'z');
+    REQUIRE(v.size() == 12);
+    REQUIRE(v.at<0>(11) == 9);
+    REQUIRE(v.at<2>(11) == "9");
+
+    v.clear();
+    v.shrink_to_fit();
+    REQUIRE(v.empty());
+    REQUIRE(v.capacity() == 0);
+  }
+
+  SECTION("values from other groups") {
+    multivector<groups<types<std::string>, types<std::string>>> w;
+    std::string a(32, 'a');
+    std::string b(32, 'b');
+    w.push_back(a, b);
+    for (int i = 1; i < 20; ++i) {
+      w.push_back(w.at<1>(0), w.at<0>(0));
+    }
+
+    REQUIRE(w.size() == 20);
+    for (int i = 1; i < 20; ++i) {
+      REQUIRE(w.at<0>(i) == b);
+      REQUIRE(w.at<1>(i) == a);
+    }
+  }
+}
+
+TEST_CASE("static multivector", "[static_multivector]") {
+  using namespace nete::tl;
+
+  SECTION("layout") {
+    using multivector_type = static_multivector<types<char, double, short>, 4>;
+
+    static_assert(multivector_type::capacity() == 4, "");
+    static_assert(multivector_type::storage_size ==
+                      multivector<types<char, double, short>>::storage_size(4),
+                  "");
+    static_assert(multivector_type::column_offset<1>::value == 0, "");
+    static_assert(multivector_type::column_offset<2>::value == 32, "");
+    static_assert(multivector_type::column_offset<0>::value == 40, "");
+
+    multivector_type v;
+    v.push_back('a', 0.5, 1);
+    v.push_back('b', 1.5, 2);
+
+    REQUIRE(v.size() == 2);
+    REQUIRE(static_cast<const void *>(v.data<1>()) ==
+            static_cast<const void *>(v.storage()));
+    REQUIRE(static_cast<const void *>(v.storage()) >=
+            static_cast<const void *>(&v));
+    REQUIRE(static_cast<const void *>(v.storage()) <
+            static_cast<const void *>(&v + 1));
+    REQUIRE(v.at<0>(1) == 'b');
+    REQUIRE(v.at<1>(1) == 1.5);
+    REQUIRE(v.at<2>(1) == 2);
+
+    v.resize(4, 'c', 2.5, 3);
+    REQUIRE(v.full());
+    REQUIRE(v.at<0>(3) == 'c');
+  }
+
+  SECTION("non-trivial types") {
+    using multivector_type = static_multivector<types<std::string, int>, 8>;
+
+    multivector_type v(3, "x", 1);
+    v.push_back("y", 2);
+    v.push_back(v.at<0>(0), v.at<1>(0));
+
+    multivector_type copy = v;
+    REQUIRE(v.erase_unordered(1) == 4);
+    v.swap(0, 1);
+
+    REQUIRE(v.size() == 4);
+    REQUIRE(v.at<0>(0) == "x");
+    REQUIRE(v.at<0>(1) == "x");
+    REQUIRE(v.at<0>(2) == "x");
+    REQUIRE(v.at<0>(3) == "y");
+
+    multivector_type moved = std::move(copy);
+    REQUIRE(copy.empty());
+    REQUIRE(moved.size() == 5);
+    REQUIRE(moved.at<0>(3) == "y");
+    REQUIRE(moved.at<1>(3) == 2);
+
+    copy = moved;
+    REQUIRE(copy.size() == 5);
+    REQUIRE(copy.at<0>(4) == "x");
+
+    int sum = 0;
+    for (std::tuple<const std::string &, const int &> row :
+         static_cast<const multivector_type &>(copy).zip<0, 1>()) {
+      sum += std::get<1>(row);
+    }
+    REQUIRE(sum == 6);
+  }
+}
+
+struct wide_tile_multivector_traits {
+  using allocator_type = nete::tl::malloc_allocator<char>;
+  using size_type = size_t;
+  static constexpr bool disable_initialization = false;
+  static constexpr std::size_t tile_width = 4;
+  static constexpr std::size_t column_alignment = 16;
+};
+
+TEST_CASE("tiled multivector", "[tiled_multivector]") {
+  using namespace nete::tl;
+
+  SECTION("layout") {
+    using multivector_type = tiled_multivector<types<char, uint16_t, double>>;
+
+    // 8 doubles, 8 uint16_t at 64, 8 chars at 80
+    std::size_t tile_size = multivector_type::tile_size;
+    REQUIRE(tile_size == 88);
+
+    multivector_type v;
+    for (int i = 0; i < 20; ++i) {
+      v.push_back('a' + i, i, i * 0.5);
+    }
+
+    REQUIRE(v.size() == 20);
+    REQUIRE(v.tile_count() == 3);
+    REQUIRE(v.capacity() % 8 == 0);
+    for (int i = 0; i < 20; ++i) {
+      REQUIRE(v.at<0>(i) == 'a' + i);
+      REQUIRE(v.at<1>(i) == i);
+      REQUIRE(v.at<2>(i) == i * 0.5);
+    }
+
+    double *tile = v.tile_data<2>(1);
+    REQUIRE(reinterpret_cast<const char *>(tile) -
+                reinterpret_cast<const char *>(v.tile_data<2>(0)) ==
+            88);
+    REQUIRE(reinterpret_cast<const char *>(v.tile_data<0>(0)) -
+                reinterpret_cast<const char *>(v.tile_data<2>(0)) ==
+            80);
+    for (int lane = 0; lane < 8; ++lane) {
+      REQUIRE(tile[lane] == (8 + lane) * 0.5);
+      REQUIRE(v.tile_data<1>(2)[lane % 4] == 16 + lane % 4);
+    }
+  }
+
+  SECTION("traits") {
+    using multivector_type =
+        tiled_multivector<types<char, float>, wide_tile_multivector_traits>;
+
+    std::size_t tile_width = multivector_type::tile_width;
+    std::size_t tile_size = multivector_type::tile_size;
+    REQUIRE(tile_width == 4);
+    REQUIRE(tile_size == 32);
+
+    multivector_type v(10, 'x', 1.5f);
+    REQUIRE(v.tile_count() == 3);
+    for (std::size_t tile = 0; tile < v.tile_count(); ++tile) {
+      REQUIRE(reinterpret_cast<std::uintptr_t>(v.tile_data<1>(tile)) % 16 ==
+              0);
+    }
+
+    v.resize(3);
+    v.shrink_to_fit();
+    REQUIRE(v.capacity() == 4);
+    for (int i = 0; i < 3; ++i) {
+      REQUIRE(v.at<0>(i) == 'x');
+      REQUIRE(v.at<1>(i) == 1.5f);
+    }
+  }
+
+  SECTION("non-trivial types") {
+    using multivector_type = tiled_multivector<types<std::string, int>>;
+
+    multivector_type v;
+    for (int i = 0; i < 50; ++i) {
+      v.push_back(std::to_string(i), i);
+    }
+    v.push_back(v.at<0>(7), v.at<1>(7));
+
+    multivector_type copy = v;
+    v.pop_back();
+    v.resize(60, "x", -1);
+    v.swap(0, 59);
+
+    REQUIRE(copy.size() == 51);
+    REQUIRE(copy.at<0>(50) == "7");
+    REQUIRE(v.size() == 60);
+    REQUIRE(v.at<0>(0) == "x");
+    REQUIRE(v.at<0>(59) == "0");
+    for (int i = 1; i < 50; ++i) {
+      REQUIRE(v.at<0>(i) == std::to_string(i));
+      REQUIRE(v.at<1>(i) == i);
+      REQUIRE(copy.at<0>(i) == std::to_string(i));
+    }
+
+    v.clear();
+    REQUIRE(v.empty());
+    REQUIRE(v.tile_count() == 0);
+  }
+}
+
+struct small_segment_multivector_traits {
+  using allocator_type = std::allocator<char>;
+  using size_type = size_t;
+  static constexpr bool disable_initialization = false;
+  static constexpr std::size_t segment_size = 16;
+  static constexpr std::size_t column_alignment = 32;
+};
+
+TEST_CASE("segmented multivector", "[segmented_multivector]") {
+  using namespace nete::tl;
+
+  SECTION("stable addresses") {
+    using multivector_type =
+        segmented_multivector<types<char, double>,
+                              small_segment_multivector_traits>;
+
+    multivector_type v;
+    v.push_back('a', 0.0);
+    const char *first_char = &v.at<0>(0);
+    const double *first_double = &v.at<1>(0);
+
+    for (int i = 1; i < 100; ++i) {
+      v.push_back('a' + i % 26, i * 0.5);
+    }
+    v.push_back(v.at<0>(3), v.at<1>(3));
+
+    REQUIRE(v.size() == 101);
+    REQUIRE(v.capacity() == 112);
+    REQUIRE(v.segment_count() == 7);
+    REQUIRE(static_cast<const void *>(first_char) ==
+            static_cast<const void *>(&v.at<0>(0)));
+    REQUIRE(first_double == &v.at<1>(0));
+    REQUIRE(v.at<0>(100) == 'd');
+    REQUIRE(v.at<1>(100) == 1.5);
+    for (int i = 0; i < 100; ++i) {
+      REQUIRE(v.at<0>(i) == 'a' + i % 26);
+      REQUIRE(v.at<1>(i) == i * 0.5);
+    }
+    for (std::size_t segment = 0; segment < v.segment_count(); ++segment) {
+      REQUIRE(reinterpret_cast<std::uintptr_t>(v.segment_data<1>(segment)) %
+                  32 ==
+              0);
+      REQUIRE(v.segment_data<1>(segment)[3] == (segment * 16 + 3) * 0.5);
+    }
+
+    v.resize(20);
+    v.shrink_to_fit();
+    REQUIRE(v.capacity() == 32);
+    REQUIRE(first_double == &v.at<1>(0));
+  }
+
+  SECTION("iteration") {
+    using multivector_type =
+        segmented_multivector<types<int, float>,
+                              small_segment_multivector_traits>;
+
+    multivector_type v(40, 1, 2.0f);
+    int i = 0;
+    for (std::tuple<int &, float &> row : v.zip<0, 1>()) {
+      std::get<0>(row) = i++;
+      std::get<1>(row) *= 2;
+    }
+    REQUIRE(i == 40);
+
+    const multivector_type &cv = v;
+    i = 0;
+    for (std::tuple<const int &> row : cv.zip<0>()) {
+      REQUIRE(std::get<0>(row) == i++);
+    }
+    REQUIRE(i == 40);
+
+    std::size_t rows = 0;
+    v.for_each_segment([&rows](std::size_t count, int *ints, float *floats) {
+      for (std::size_t lane = 0; lane < count; ++lane) {
+        REQUIRE(ints[lane] == static_cast<int>(rows + lane));
+        REQUIRE(floats[lane] == 4.0f);
+      }
+      rows += count;
+    });
+    REQUIRE(rows == 40);
+
+    float sum = 0;
+    v.for_each_segment<1>([&sum](std::size_t count, float *floats) {
+      for (std::size_t lane = 0; lane < count; ++lane) {
+        sum += floats[lane];
+      }
+    });
+    REQUIRE(sum == 160.0f);
+  }
+
+  SECTION("non-trivial types") {
+    using multivector_type =
+        segmented_multivector<types<std::string, int>,
+                              small_segment_multivector_traits>;
+
+    multivector_type v;
+    for (int i = 0; i < 50; ++i) {
+      v.push_back(std::to_string(i), i);
+    }
+    const std::string *first = &v.at<0>(0);
+
+    multivector_type copy = v;
+    v.pop_back();
+    v.resize(60, "x", -1);
+    v.swap(0, 59);
+
+    REQUIRE(first == &v.at<0>(0));
+    REQUIRE(copy.size() == 50);
+    REQUIRE(v.size() == 60);
+    REQUIRE(v.at<0>(0) == "x");
+    REQUIRE(v.at<0>(59) == "0");
+    for (int i = 1; i < 49; ++i) {
+      REQUIRE(v.at<0>(i) == std::to_string(i));
+      REQUIRE(copy.at<0>(i) == std::to_string(i));
+    }
+
+    multivector_type moved = std::move(copy);
+    REQUIRE(copy.empty());
+    REQUIRE(moved.size() == 50);
+    REQUIRE(moved.at<0>(49) == "49");
+
+    v.clear();
+    REQUIRE(v.empty());
+    REQUIRE(v.segment_count() == 0);
+  }
+}
+
+TEST_CASE("fast_vector capacity", "[fast_vector]") {
+  using namespace nete::tl;
+
+  SECTION("push_back") {
+    int size = 1000;
+
+    fast_vector<int> v;
+
+    REQUIRE(v.size() == 0);
+    REQUIRE(v.capacity() == 0);
+
+    int reallocations = 0;
+    const int *v_data = v.data();
+
+    for (int i = 0; i < size; ++i) {
+      v.push_back(i);
+      if (v.data() != v_data) {
+        v_data = v.data();
+        ++reallocations;
+      }
+    }
+
+    REQUIRE(v.size() == size);
+    REQUIRE(v.capacity() >= size);
+    REQUIRE(reallocations <= 10);
+
+    for (int i = 0; i < size; ++i) {
+      REQUIRE(v.at(i) == i);
+    }
+  }
+
+  SECTION("push_back of own element") {
+    fast_vector<int> v(1, 42);
+
+    REQUIRE(v.capacity() == 1);
+
+    v.push_back(v.at(0));
+
+    REQUIRE(v.size() == 2);
+    REQUIRE(v.at(1) == 42);
+  }
+
+  SECTION("reserve") {
+    fast_vector<int> v(4, 7);
+
+    v.reserve(64);
+
+    REQUIRE(v.size() == 4);
+    REQUIRE(v.capacity() >= 64);
+
+    const int *v_data = v.data();
+
+    for (int i = 4; i < 64; ++i) {
+      v.push_back(i);
+    }
+
+    REQUIRE(v_data == v.data());
+
+    for (int i = 0; i < 4; ++i) {
+      REQUIRE(v.at(i) == 7);
+    }
+
+    v.reserve(8);
+
+    REQUIRE(v.capacity() >= 64);
+  }
+
+  SECTION("clear and shrink_to_fit") {
+    fast_vector<int> v(16, 7);
+
+    v.pop_back();
+
+    REQUIRE(v.size() == 15);
+    REQUIRE(v.capacity() == 16);
+
+    v.shrink_to_fit();
+
+    REQUIRE(v.size() == 15);
+    REQUIRE(v.capacity() == 15);
+
+    for (int i = 0; i < 15; ++i) {
+      REQUIRE(v.at(i) == 7);
+    }
+
+    v.clear();
+
+    REQUIRE(v.empty());
+    REQUIRE(v.capacity() == 15);
+
+    v.shrink_to_fit();
+
+    REQUIRE(v.capacity() == 0);
+  }
+
+  SECTION("reallocating allocator") {
+    int size = 1000;
+
+    fast_vector<int, malloc_allocator<int>> v;
+
+    for (int i = 0; i < size; ++i) {
+      v.push_back(i);
+    }
+
+    v.resize(size / 2);
+    v.shrink_to_fit();
+
+    REQUIRE(v.capacity() == size / 2);
+
+    for (int i = 0; i < size / 2; ++i) {
+      REQUIRE(v.at(i) == i);
+    }
+  }
+
+  SECTION("append and insert") {
+    const int values[] = {1, 2, 3, 4, 5};
+    fast_vector<int> v;
+
+    v.append(values, 5);
+    v.append(v.data() + 1, 3);
+
+    REQUIRE(v.size() == 8);
+    REQUIRE(v.at(4) == 5);
+    REQUIRE(v.at(5) == 2);
+    REQUIRE(v.at(7) == 4);
+
+    auto it = v.insert(v.begin() + 1, values + 3, values + 5);
+    REQUIRE(it == v.begin() + 1);
+    REQUIRE(v.size() == 10);
+    const int expected[] = {1, 4, 5, 2, 3, 4, 5, 2, 3, 4};
+    for (int i = 0; i < 10; ++i) {
+      REQUIRE(v.at(i) == expected[i]);
+    }
+
+    v.insert(v.begin(), v.data() + 8, v.data() + 10);
+    v.insert(v.end(), values, values + 1);
+    REQUIRE(v.size() == 13);
+    REQUIRE(v.at(0) == 3);
+    REQUIRE(v.at(1) == 4);
+    REQUIRE(v.at(2) == 1);
+    REQUIRE(v.at(12) == 1);
+
+    v.resize_uninitialized(20);
+    REQUIRE(v.size() == 20);
+    REQUIRE(v.at(12) == 1);
+  }
+
+  SECTION("growth policy") {
+    fast_vector<int, std::allocator<int>, geometric_growth<3, 2, 4>> v;
+
+    v.push_back(1);
+
+    REQUIRE(v.capacity() == 4);
+
+    for (int i = 0; i < 4; ++i) {
+      v.push_back(i);
+    }
+
+    REQUIRE(v.capacity() == 6);
+  }
+}
+
+TEST_CASE("small_fast_vector", "[fast_vector]") {
+  using namespace nete::tl;
+
+  SECTION("inline storage") {
+    small_fast_vector<int, 4> v;
+
+    REQUIRE(v.is_inline());
+    REQUIRE(v.capacity() == 4);
+    REQUIRE(static_cast<const void *>(v.data()) >=
+            static_cast<const void *>(&v));
+    REQUIRE(static_cast<const void *>(v.data()) <
+            static_cast<const void *>(&v + 1));
+
+    for (int i = 0; i < 4; ++i) {
+      v.push_back(i);
+    }
+    REQUIRE(v.is_inline());
+
+    v.push_back(v.at(3));
+    REQUIRE(!v.is_inline());
+    REQUIRE(v.size() == 5);
+    REQUIRE(v.capacity() >= 5);
+    for (int i = 0; i < 4; ++i) {
+      REQUIRE(v.at(i) == i);
+    }
+    REQUIRE(v.at(4) == 3);
+
+    v.resize(2);
+    v.shrink_to_fit();
+    REQUIRE(v.is_inline());
+    REQUIRE(v.capacity() == 4);
+    REQUIRE(v.at(0) == 0);
+    REQUIRE(v.at(1) == 1);
+  }
+
+  SECTION("copy and move") {
+    small_fast_vector<int, 4> small(3, 7);
+    small_fast_vector<int, 4> big(100, 9);
+    const int *big_data = big.data();
+
+    small_fast_vector<int, 4> small_copy = small;
+    small_fast_vector<int, 4> big_copy = big;
+    REQUIRE(small_copy.is_inline());
+    REQUIRE(big_copy.size() == 100);
+    REQUIRE(big_copy.at(99) == 9);
+
+    small_fast_vector<int, 4> big_moved = std::move(big);
+    REQUIRE(big_moved.data() == big_data);
+    REQUIRE(big.empty());
+    REQUIRE(big.is_inline());
+
+    big_moved = std::move(small);
+    REQUIRE(big_moved.is_inline());
+    REQUIRE(big_moved.size() == 3);
+    REQUIRE(big_moved.at(2) == 7);
+
+    small_copy = big_copy;
+    REQUIRE(small_copy.size() == 100);
+    REQUIRE(small_copy.at(50) == 9);
+  }
+
+  SECTION("append and insert") {
+    const int values[] = {1, 2, 3};
+    small_fast_vector<int, 4> v;
+
+    v.append(values, 3);
+    REQUIRE(v.is_inline());
+
+    v.insert(v.begin(), v.data() + 1, v.data() + 3);
+    REQUIRE(!v.is_inline());
+    const int expected[] = {2, 3, 1, 2, 3};
+    REQUIRE(v.size() == 5);
+    for (int i = 0; i < 5; ++i) {
+      REQUIRE(v.at(i) == expected[i]);
+    }
+  }
+
+  SECTION("reallocating allocator") {
+    small_fast_vector<int, 8, malloc_allocator<int>> v;
+
+    for (int i = 0; i < 1000; ++i) {
+      v.push_back(i);
+    }
+    v.resize(500);
+    v.shrink_to_fit();
+
+    REQUIRE(v.capacity() == 500);
+    for (int i = 0; i < 500; ++i) {
+      REQUIRE(v.at(i) == i);
+    }
+
+    v.insert(v.begin() + 1, v.data(), v.data() + 2);
+
+    REQUIRE(v.size() == 502);
+    REQUIRE(v.at(1) == 0);
+    REQUIRE(v.at(2) == 1);
+    REQUIRE(v.at(3) == 1);
+    REQUIRE(v.at(501) == 499);
+  }
+}